@@ -326,6 +326,19 @@ static inline int block_FindStartcodeFromOffset(
                 /* Then parsing boundary with legacy code */
                 i_offset = p_block->i_buffer - (i_startcode_length - 1);
             }
+            else if( !p_startcode_matcher && !i_match )
+            {
+                /* Skip to the next candidate 1st byte */
+                const uint8_t *p_first = (const uint8_t *)
+                    memchr( &p_block->p_buffer[i_offset], p_startcode[0],
+                            p_block->i_buffer - i_offset );
+                if( p_first == NULL )
+                {
+                    i_offset = p_block->i_buffer;
+                    break;
+                }
+                i_offset = p_first - p_block->p_buffer;
+            }
 
             bool b_matched = ( p_startcode_matcher )
                            ? p_startcode_matcher( p_block->p_buffer[i_offset], i_match, p_startcode )
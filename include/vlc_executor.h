@@ -31,6 +31,21 @@ extern "C" {
 /** Executor type (opaque) */
 typedef struct vlc_executor vlc_executor_t;
 
+struct vlc_executor_queue;
+
+/**
+ * Priority classes of runnables.
+ *
+ * Pending runnables of a higher priority class are always started before
+ * runnables of a lower one, whatever their submission order.
+ */
+enum vlc_executor_priority {
+    VLC_EXECUTOR_PRIORITY_HIGH,
+    VLC_EXECUTOR_PRIORITY_NORMAL,
+};
+
+#define VLC_EXECUTOR_PRIORITY_COUNT (VLC_EXECUTOR_PRIORITY_NORMAL + 1)
+
 /**
  * A Runnable encapsulates a task to be run from an executor thread.
  */
@@ -60,6 +75,7 @@ struct vlc_runnable {
 
     /* Private data used by the vlc_executor_t (do not touch) */
     struct vlc_list node;
+    struct vlc_executor_queue *queue;
 };
 
 /**
@@ -139,12 +155,32 @@ vlc_executor_Delete(vlc_executor_t *executor);
  *
  * For simplicity, it is discouraged to submit a runnable previously submitted.
  *
+ * The runnable is submitted with the normal priority (see
+ * vlc_executor_SubmitPriority()).
+ *
  * \param executor the executor
  * \param runnable the task to run
  */
 VLC_API void
 vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable);
 
+/**
+ * Submit a runnable for execution, with a given priority.
+ *
+ * This is the same as vlc_executor_Submit(), except that the runnable will be
+ * started before any pending runnable of a lower priority class. Runnables of
+ * the same priority class are started in submission order (in practice,
+ * approximately when several threads are running).
+ *
+ * \param executor the executor
+ * \param runnable the task to run
+ * \param priority the priority class of the task
+ */
+VLC_API void
+vlc_executor_SubmitPriority(vlc_executor_t *executor,
+                            struct vlc_runnable *runnable,
+                            enum vlc_executor_priority priority);
+
 /**
  * Cancel a runnable previously submitted.
  *
@@ -514,7 +514,9 @@ static inline void vlc_frame_ChainProperties( vlc_frame_t *p_list, int *pi_count
  * Gathers a chain into a single vlc_frame_t
  *
  * All frames in the chain are gathered into a single vlc_frame_t and the
- * original chain is released.
+ * original chain is released. When the other frames fit in the reserved
+ * space around the largest one, they are copied there and no new frame is
+ * allocated.
  * 
  * @param   p_list  Pointer to the first vlc_frame_t of the chain to gather
  * @return  Returns a pointer to a new vlc_frame_t or NULL if the frame can not
@@ -535,6 +537,60 @@ static inline vlc_frame_t *vlc_frame_ChainGather( vlc_frame_t *p_list )
 
     vlc_frame_ChainProperties( p_list, NULL, &i_total, &i_length );
 
+    /* Gather in place into the largest frame, if the others fit
+     * in its reserved head and tail room */
+    vlc_frame_t *p_largest = p_list;
+    size_t i_before = 0, i_largest_before = 0;
+    for( g = p_list; g != NULL; g = g->p_next )
+    {
+        if( g->i_buffer > p_largest->i_buffer )
+        {
+            p_largest = g;
+            i_largest_before = i_before;
+        }
+        i_before += g->i_buffer;
+    }
+
+    const size_t i_after = i_total - i_largest_before - p_largest->i_buffer;
+    if( (size_t)(p_largest->p_buffer - p_largest->p_start) >= i_largest_before &&
+        p_largest->i_size - (size_t)(p_largest->p_buffer - p_largest->p_start)
+                          - p_largest->i_buffer >= i_after )
+    {
+        uint8_t *p_head = p_largest->p_buffer - i_largest_before;
+        uint8_t *p_tail = p_largest->p_buffer + p_largest->i_buffer;
+        g = p_list;
+        for( ; g != p_largest; g = g->p_next )
+        {
+            memcpy( p_head, g->p_buffer, g->i_buffer );
+            p_head += g->i_buffer;
+        }
+        for( g = p_largest->p_next; g != NULL; g = g->p_next )
+        {
+            memcpy( p_tail, g->p_buffer, g->i_buffer );
+            p_tail += g->i_buffer;
+        }
+
+        /* the gathered frame takes the properties of the chain head */
+        p_largest->i_flags = p_list->i_flags;
+        p_largest->i_pts   = p_list->i_pts;
+        p_largest->i_dts   = p_list->i_dts;
+
+        /* unlink it from the chain and release the others */
+        vlc_frame_t **pp = &p_list;
+        while( *pp != p_largest )
+            pp = &(*pp)->p_next;
+        *pp = p_largest->p_next;
+        p_largest->p_next = NULL;
+
+        p_largest->p_buffer -= i_largest_before;
+        p_largest->i_buffer = i_total;
+        p_largest->i_nb_samples = 0;
+        p_largest->i_length = i_length;
+
+        vlc_frame_ChainRelease( p_list );
+        return p_largest;
+    }
+
     g = vlc_frame_Alloc( i_total );
     if( !g )
         return NULL;
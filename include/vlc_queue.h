@@ -47,6 +47,7 @@ typedef struct vlc_queue
     ptrdiff_t next_offset;
     vlc_mutex_t lock;
     vlc_cond_t wait;
+    unsigned waiters;
 } vlc_queue_t;
 
 /**
@@ -119,7 +120,10 @@ static inline void vlc_queue_Signal(vlc_queue_t *q)
  */
 static inline void vlc_queue_Wait(vlc_queue_t *q)
 {
+    /* If cancelled, the count stays too high: this only costs extra signals */
+    q->waiters++;
     vlc_cond_wait(&q->wait, &q->lock);
+    q->waiters--;
 }
 
 /**
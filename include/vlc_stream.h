@@ -223,6 +223,25 @@ VLC_USED;
  */
 VLC_API ssize_t vlc_stream_Peek(stream_t *, const uint8_t **, size_t) VLC_USED;
 
+/**
+ * Peeks at data from a byte stream, without waiting for all of it.
+ *
+ * Unlike vlc_stream_Peek(), this function only waits for some data to be
+ * available. It then returns what the stream has already received, up to
+ * the requested bytes count.
+ *
+ * \note
+ * The buffer remains valid until the next read/peek or seek operation on the
+ * same stream. In case of error, the buffer address is undefined.
+ *
+ * \param bufp storage space for the buffer address [OUT]
+ * \param len maximum number of bytes to peek
+ * \return the number of bytes available (zero only at the end of the stream),
+ * or a negative value on error.
+ */
+VLC_API ssize_t vlc_stream_PeekPartial(stream_t *, const uint8_t **, size_t)
+VLC_USED;
+
 /**
  * Reads a data block from a byte stream.
  *
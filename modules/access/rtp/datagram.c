@@ -24,6 +24,7 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <time.h>
 #ifdef HAVE_POLL_H
 #include <poll.h>
 #endif
@@ -77,6 +78,71 @@ static ssize_t vlc_datagram_Recv(struct vlc_dtls *dgs, struct iovec *iov,
     return ret;
 }
 
+#ifdef HAVE_RECVMMSG
+#define VLEN 32
+
+static int vlc_datagram_RecvBatch(struct vlc_dtls *dgs,
+                                  struct vlc_dtls_msg *msgs, unsigned count)
+{
+    struct mmsghdr hdrs[VLEN];
+    struct iovec iov[VLEN];
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof (struct timespec))];
+    } cmsg[VLEN];
+    int fd = container_of(dgs, struct vlc_dgram_sock, s)->fd;
+
+    if (count > VLEN)
+        count = VLEN;
+
+    for (unsigned i = 0; i < count; i++) {
+        iov[i].iov_base = msgs[i].buf;
+        iov[i].iov_len = msgs[i].len;
+        hdrs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = &iov[i],
+            .msg_iovlen = 1,
+            .msg_control = cmsg[i].buf,
+            .msg_controllen = sizeof (cmsg[i].buf),
+        };
+    }
+
+    int ret = recvmmsg(fd, hdrs, count, MSG_WAITFORONE, NULL);
+    if (ret <= 0)
+        return ret;
+
+    /* Kernel timestamps are on the wall clock: rebase them on the VLC clock
+     * so that the datagrams keep their own arrival times in a batch. */
+    struct timespec ts;
+    vlc_tick_t now = vlc_tick_now();
+    vlc_tick_t wallnow = VLC_TICK_INVALID;
+
+    if (clock_gettime(CLOCK_REALTIME, &ts) == 0)
+        wallnow = vlc_tick_from_timespec(&ts);
+
+    for (int i = 0; i < ret; i++) {
+        struct msghdr *msg = &hdrs[i].msg_hdr;
+
+        msgs[i].len = hdrs[i].msg_len;
+        msgs[i].truncated = (msg->msg_flags & MSG_TRUNC) != 0;
+        msgs[i].timestamp = VLC_TICK_INVALID;
+#ifdef SO_TIMESTAMPNS
+        for (struct cmsghdr *c = CMSG_FIRSTHDR(msg); c != NULL;
+             c = CMSG_NXTHDR(msg, c))
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS
+             && wallnow != VLC_TICK_INVALID) {
+                memcpy(&ts, CMSG_DATA(c), sizeof (ts));
+
+                vlc_tick_t age = wallnow - vlc_tick_from_timespec(&ts);
+                if (age >= 0 && age < now)
+                    msgs[i].timestamp = now - age;
+            }
+#endif
+    }
+
+    return ret;
+}
+#endif
+
 static ssize_t vlc_datagram_Send(struct vlc_dtls *dgs,
                                  const struct iovec *iov, unsigned iovlen)
 {
@@ -94,6 +160,11 @@ static const struct vlc_dtls_operations vlc_datagram_ops = {
     vlc_datagram_GetPollFD,
     vlc_datagram_Recv,
     vlc_datagram_Send,
+#ifdef HAVE_RECVMMSG
+    vlc_datagram_RecvBatch,
+#else
+    NULL,
+#endif
 };
 
 struct vlc_dtls *vlc_datagram_CreateFD(int fd)
@@ -103,6 +174,10 @@ struct vlc_dtls *vlc_datagram_CreateFD(int fd)
     if (likely(s != NULL)) {
         s->fd = fd;
         s->s.ops = &vlc_datagram_ops;
+#if defined (HAVE_RECVMMSG) && defined (SO_TIMESTAMPNS)
+        /* Best effort: keeps the arrival times of batched datagrams */
+        setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &(int){ 1 }, sizeof (int));
+#endif
     }
 
     return &s->s;
@@ -145,6 +220,7 @@ static const struct vlc_dtls_operations vlc_dccp_ops = {
     vlc_datagram_GetPollFD,
     vlc_dccp_Recv,
     vlc_datagram_Send,
+    NULL,
 };
 
 struct vlc_dtls *vlc_dccp_CreateFD(int fd)
@@ -47,6 +47,7 @@
 #endif
 
 #define DEFAULT_MRU (1500u - (20 + 8))
+#define VLEN 32 /* datagrams per receive call */
 
 /**
  * Processes a packet received from the RTP socket.
@@ -95,6 +96,15 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+static void rtp_cleanup_blocks (void *data)
+{
+    block_t **blocks = data;
+
+    for (size_t i = 0; i < VLEN; i++)
+        if (blocks[i] != NULL)
+            block_Release (blocks[i]);
+}
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -104,7 +114,11 @@ void *rtp_dgram_thread (void *opaque)
     demux_sys_t *sys = demux->p_sys;
     vlc_tick_t deadline = VLC_TICK_INVALID;
     struct vlc_dtls *rtp_sock = sys->rtp_sock;
+    /* Receive buffers; only the ones handed over get reallocated */
+    block_t *blocks[VLEN] = { NULL };
+    struct vlc_dtls_msg msgs[VLEN];
 
+    vlc_cleanup_push (rtp_cleanup_blocks, blocks);
     for (;;)
     {
         struct pollfd ufd[1];
@@ -122,32 +136,50 @@ void *rtp_dgram_thread (void *opaque)
 
         if (ufd[0].revents)
         {
-            block_t *block = block_Alloc(DEFAULT_MRU);
-            if (unlikely(block == NULL))
+            unsigned count = 0;
+
+            while (count < VLEN)
+            {
+                if (blocks[count] == NULL)
+                {
+                    blocks[count] = block_Alloc(DEFAULT_MRU);
+                    if (unlikely(blocks[count] == NULL))
+                        break;
+                }
+                msgs[count].buf = blocks[count]->p_buffer;
+                msgs[count].len = blocks[count]->i_buffer;
+                count++;
+            }
+
+            if (unlikely(count == 0))
                 break; /* we are totallly screwed */
 
-            bool truncated;
-            ssize_t len = vlc_dtls_Recv(rtp_sock, block->p_buffer,
-                                       block->i_buffer, &truncated);
-            if (len >= 0) {
-                if (truncated) {
+            int val = vlc_dtls_RecvBatch(rtp_sock, msgs, count);
+            if (val < 0)
+            {
+                if (errno == EPIPE)
+                    break; /* connection terminated */
+                msg_Warn (demux, "RTP network error: %s",
+                          vlc_strerror_c(errno));
+            }
+
+            for (int i = 0; i < val; i++)
+            {
+                block_t *block = blocks[i];
+
+                blocks[i] = NULL;
+                if (msgs[i].truncated) {
                     msg_Err(demux, "packet truncated (MRU was %zu)",
                             block->i_buffer);
                     block->i_flags |= BLOCK_FLAG_CORRUPTED;
                 }
                 else
-                    block->i_buffer = len;
+                    block->i_buffer = msgs[i].len;
+                /* reception time, if known */
+                block->i_pts = msgs[i].timestamp;
 
                 rtp_process (demux, block);
             }
-            else
-            {
-                if (errno == EPIPE)
-                    break; /* connection terminated */
-                msg_Warn (demux, "RTP network error: %s",
-                          vlc_strerror_c(errno));
-                block_Release (block);
-            }
 
             n--;
         }
@@ -157,5 +189,7 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TICK_INVALID;
         vlc_restorecancel (canc);
     }
+    vlc_cleanup_pop ();
+    rtp_cleanup_blocks (blocks);
     return NULL;
 }
@@ -30,6 +30,16 @@ struct vlc_dtls {
     const struct vlc_dtls_operations *ops;
 };
 
+/**
+ * Datagram slot for vlc_dtls_RecvBatch().
+ */
+struct vlc_dtls_msg {
+    void *buf; /**< Receive buffer */
+    size_t len; /**< Buffer size on input, datagram size on output */
+    bool truncated; /**< Whether the datagram did not fit in the buffer */
+    vlc_tick_t timestamp; /**< Reception time, or VLC_TICK_INVALID */
+};
+
 struct vlc_dtls_operations {
     void (*close)(struct vlc_dtls *);
 
@@ -37,6 +47,7 @@ struct vlc_dtls_operations {
     ssize_t (*readv)(struct vlc_dtls *, struct iovec *iov, unsigned len,
                      bool *restrict truncated);
     ssize_t (*writev)(struct vlc_dtls *, const struct iovec *iov, unsigned len);
+    int (*readmv)(struct vlc_dtls *, struct vlc_dtls_msg *msgs, unsigned count);
 };
 
 static inline void vlc_dtls_Close(struct vlc_dtls *dgs)
@@ -57,6 +68,30 @@ static inline ssize_t vlc_dtls_Recv(struct vlc_dtls *dgs, void *buf, size_t len,
     return dgs->ops->readv(dgs, &iov, 1, truncated);
 }
 
+/**
+ * Receives one or more datagrams.
+ *
+ * Blocks until at least one datagram is available, then returns as many of
+ * the already queued datagrams as fit in the supplied slots.
+ *
+ * \return the number of datagrams received, or -1 on error
+ */
+static inline int vlc_dtls_RecvBatch(struct vlc_dtls *dgs,
+                                     struct vlc_dtls_msg *msgs, unsigned count)
+{
+    if (dgs->ops->readmv != NULL)
+        return dgs->ops->readmv(dgs, msgs, count);
+
+    ssize_t len = vlc_dtls_Recv(dgs, msgs[0].buf, msgs[0].len,
+                                &msgs[0].truncated);
+    if (len < 0)
+        return -1;
+
+    msgs[0].len = len;
+    msgs[0].timestamp = VLC_TICK_INVALID;
+    return 1;
+}
+
 static inline ssize_t vlc_dtls_Send(struct vlc_dtls *dgs, const void *buf,
                                    size_t len)
 {
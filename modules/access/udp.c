@@ -53,13 +53,27 @@
  */
 #define MRU 65507u
 
+/* Datagrams received per system call. Only the pages of the buffers actually
+ * written by the kernel get committed, so small datagrams stay cheap. */
+#ifdef HAVE_RECVMMSG
+# define VLEN 16
+#else
+# define VLEN 1
+#endif
+
 typedef struct {
     int fd;
     int timeout;
 
     size_t length;
     char *offset;
-    char buf[MRU];
+#ifdef HAVE_RECVMMSG
+    unsigned next; /* next pending datagram of the last batch */
+    unsigned count; /* datagrams in the last batch */
+    struct mmsghdr msgs[VLEN];
+    struct iovec iov[VLEN + 1];
+#endif
+    char buf[VLEN][MRU];
 } access_sys_t;
 
 static int Control(stream_t *access, int query, va_list args)
@@ -87,6 +101,15 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
 {
     access_sys_t *sys = access->p_sys;
 
+#ifdef HAVE_RECVMMSG
+    while (sys->length == 0 && sys->next < sys->count) {
+        unsigned i = sys->next++;
+
+        sys->offset = sys->buf[i];
+        sys->length = sys->msgs[i].msg_len;
+    }
+#endif
+
     if (sys->length > 0) {
         if (len > sys->length)
             len = sys->length;
@@ -110,21 +133,37 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
             return -1;
     }
 
+#ifdef HAVE_RECVMMSG
+    /* The first datagram goes straight to the caller, the rest of the batch
+     * is kept for the next calls. */
+    sys->iov[0].iov_base = buf;
+    sys->iov[0].iov_len = len;
+
+    int count = recvmmsg(sys->fd, sys->msgs, VLEN, MSG_WAITFORONE, NULL);
+    if (count <= 0)
+        return -1;
+
+    sys->next = 1;
+    sys->count = count;
+
+    ssize_t val = sys->msgs[0].msg_len;
+#else
     struct iovec iov[] = {
-        { .iov_base = buf,      .iov_len = len, },
-        { .iov_base = sys->buf, .iov_len = MRU, },
+        { .iov_base = buf,         .iov_len = len, },
+        { .iov_base = sys->buf[0], .iov_len = MRU, },
     };
     struct msghdr msg = {
         .msg_iov = iov,
         .msg_iovlen = ARRAY_SIZE(iov),
     };
     ssize_t val = recvmsg(sys->fd, &msg, 0);
+#endif
 
     if (val <= 0) /* empty (0 bytes) payload does *not* mean EOF here */
         return -1;
 
     if (unlikely((size_t)val > len)) {
-        sys->offset = sys->buf;
+        sys->offset = sys->buf[0];
         sys->length = val - len;
         val = len;
     }
@@ -148,6 +187,20 @@ static int Open( vlc_object_t *p_this )
         return VLC_ENOMEM;
 
     sys->length = 0;
+#ifdef HAVE_RECVMMSG
+    sys->next = sys->count = 0;
+    memset(sys->msgs, 0, sizeof (sys->msgs));
+    sys->msgs[0].msg_hdr.msg_iov = &sys->iov[0];
+    sys->msgs[0].msg_hdr.msg_iovlen = 2;
+    for (unsigned i = 0; i < VLEN; i++) {
+        sys->iov[i + 1].iov_base = sys->buf[i];
+        sys->iov[i + 1].iov_len = MRU;
+        if (i > 0) {
+            sys->msgs[i].msg_hdr.msg_iov = &sys->iov[i + 1];
+            sys->msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+#endif
     p_access->p_sys = sys;
     p_access->pf_read = Read;
     p_access->pf_block = NULL;
@@ -23,6 +23,8 @@
 #endif
 
 #include "SegmentTracker.hpp"
+#include "SharedResources.hpp"
+#include "http/HTTPConnectionManager.h"
 #include "playlist/BasePlaylist.hpp"
 #include "playlist/BaseRepresentation.h"
 #include "playlist/BaseAdaptationSet.h"
@@ -120,6 +122,8 @@ SegmentTracker::SegmentTracker(SharedResources *res,
     setAdaptationLogic(logic_);
     adaptationSet = adaptSet;
     format = StreamFormat::Type::Unknown;
+    bufferingLevel = 0;
+    bufferingMax = 0;
 }
 
 SegmentTracker::~SegmentTracker()
@@ -226,6 +230,7 @@ void SegmentTracker::reset()
 SegmentTracker::ChunkEntry::ChunkEntry()
 {
     chunk = nullptr;
+    prefetched = false;
 }
 
 SegmentTracker::ChunkEntry::ChunkEntry(SegmentChunk *c, Position p, vlc_tick_t s, vlc_tick_t d, vlc_tick_t dt)
@@ -235,6 +240,7 @@ SegmentTracker::ChunkEntry::ChunkEntry(SegmentChunk *c, Position p, vlc_tick_t s
     duration = d;
     starttime = s;
     displaytime = dt;
+    prefetched = false;
 }
 
 bool SegmentTracker::ChunkEntry::isValid() const
@@ -243,7 +249,7 @@ bool SegmentTracker::ChunkEntry::isValid() const
 }
 
 SegmentTracker::ChunkEntry
-SegmentTracker::prepareChunk(bool switch_allowed, Position pos,
+SegmentTracker::prepareChunk(BaseRepresentation *switchRep, Position pos,
                              AbstractConnectionManager *connManager) const
 {
     if(!adaptationSet)
@@ -260,14 +266,11 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos,
     }
     else /* continuing, or seek */
     {
-        if(!adaptationSet->isSegmentAligned() || !pos.init_sent || !pos.index_sent)
-            switch_allowed = false;
-
-        if(switch_allowed)
+        if(switchRep)
         {
             Position temp;
-            temp.rep = logic->getNextRepresentation(adaptationSet, pos.rep);
-            if(temp.rep && temp.rep != pos.rep)
+            temp.rep = switchRep;
+            if(temp.rep != pos.rep)
             {
                 /* Ensure ephemere content is updated/loaded */
                 if(temp.rep->needsUpdate(pos.number))
@@ -329,15 +332,70 @@ void SegmentTracker::resetChunksSequence()
     }
 }
 
+BaseRepresentation * SegmentTracker::decideRepresentation(const Position &pos) const
+{
+    /* Logics can be stateful (predictive, nearoptimal), so this must
+     * only be called once per chunk and its result reused */
+    if(!pos.isValid() || !adaptationSet->isSegmentAligned() ||
+       !pos.init_sent || !pos.index_sent)
+        return nullptr;
+    return logic->getNextRepresentation(adaptationSet, pos.rep);
+}
+
+unsigned SegmentTracker::getPrefetchCount(vlc_tick_t duration) const
+{
+    /* Only request ahead what the buffering logic will be willing to demux */
+    if(duration <= 0 || bufferingMax <= bufferingLevel + duration)
+        return 0;
+    vlc_tick_t count = (bufferingMax - bufferingLevel) / duration - 1;
+    return std::min(count, (vlc_tick_t) MAX_PREFETCH_SEGMENTS);
+}
+
+void SegmentTracker::prefetchChunks(vlc_tick_t duration,
+                                    AbstractConnectionManager *connManager)
+{
+    const unsigned count = getPrefetchCount(duration);
+    while(chunkssequence.size() < count)
+    {
+        Position pos = next;
+        if(!chunkssequence.empty())
+        {
+            pos = chunkssequence.back().pos;
+            ++pos;
+        }
+        if(!pos.isValid() || !pos.init_sent || !pos.index_sent)
+            break;
+
+        /* Requests are started by the chunk creation */
+        ChunkEntry chunk = prepareChunk(nullptr, pos, connManager);
+        if(!chunk.isValid())
+        {
+            delete chunk.chunk;
+            break;
+        }
+        chunk.prefetched = true;
+        chunkssequence.push_back(chunk);
+    }
+}
+
 ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed,
                                             AbstractConnectionManager *connManager)
 {
     if(!adaptationSet || !next.isValid())
         return nullptr;
 
+    BaseRepresentation *switchRep = switch_allowed ? decideRepresentation(next)
+                                                   : nullptr;
+
+    /* Prefetched chunks were requested without adaptation,
+     * drop them if the logic now wants another representation */
+    if(switchRep && !chunkssequence.empty() && chunkssequence.front().prefetched &&
+       chunkssequence.front().pos.rep != switchRep)
+        resetChunksSequence();
+
     if(chunkssequence.empty())
     {
-        ChunkEntry chunk = prepareChunk(switch_allowed, next, connManager);
+        ChunkEntry chunk = prepareChunk(switchRep, next, connManager);
         chunkssequence.push_back(chunk);
     }
 
@@ -412,7 +470,10 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed,
         notify(DiscontinuityEvent());
 
     if(!b_gap)
+    {
         ++next;
+        prefetchChunks(chunk.duration, connManager);
+    }
 
     return returnedChunk;
 }
@@ -531,8 +592,12 @@ void SegmentTracker::notifyBufferingState(bool enabled) const
 }
 
 void SegmentTracker::notifyBufferingLevel(vlc_tick_t min, vlc_tick_t max,
-                                          vlc_tick_t current, vlc_tick_t target) const
+                                          vlc_tick_t current, vlc_tick_t target)
 {
+    bufferingLevel = current;
+    bufferingMax = max;
+    if(resources && resources->getConnManager())
+        resources->getConnManager()->updateBufferingLevel(adaptationSet->getID(), current);
     notify(BufferingLevelChangedEvent(adaptationSet->getID(), min, max, current, target));
 }
 
@@ -196,7 +196,7 @@ namespace adaptive
             bool getMediaPlaybackRange(vlc_tick_t *, vlc_tick_t *, vlc_tick_t *) const;
             vlc_tick_t getMinAheadTime() const;
             void notifyBufferingState(bool) const;
-            void notifyBufferingLevel(vlc_tick_t, vlc_tick_t, vlc_tick_t, vlc_tick_t) const;
+            void notifyBufferingLevel(vlc_tick_t, vlc_tick_t, vlc_tick_t, vlc_tick_t);
             void registerListener(SegmentTrackerListenerInterface *);
             void updateSelected();
             bool bufferingAvailable() const;
@@ -213,15 +213,22 @@ namespace adaptive
                     vlc_tick_t displaytime;
                     vlc_tick_t starttime;
                     vlc_tick_t duration;
+                    bool prefetched;
             };
             std::list<ChunkEntry> chunkssequence;
-            ChunkEntry prepareChunk(bool switch_allowed, Position pos,
+            ChunkEntry prepareChunk(BaseRepresentation *, Position pos,
                                     AbstractConnectionManager *connManager) const;
             void resetChunksSequence();
+            BaseRepresentation * decideRepresentation(const Position &) const;
+            unsigned getPrefetchCount(vlc_tick_t) const;
+            void prefetchChunks(vlc_tick_t, AbstractConnectionManager *);
+            static const unsigned MAX_PREFETCH_SEGMENTS = 3;
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const TrackerEvent &) const;
             bool first;
             bool initializing;
+            vlc_tick_t bufferingLevel;
+            vlc_tick_t bufferingMax;
             Position current;
             Position next;
             StreamFormat format;
@@ -25,8 +25,11 @@
 #include "http/AuthStorage.hpp"
 #include "http/HTTPConnectionManager.h"
 #include "http/HTTPConnection.hpp"
+#include "http/SegmentCache.hpp"
 #include "encryption/Keyring.hpp"
 
+#include <vlc_configuration.h>
+
 using namespace adaptive;
 
 SharedResources::SharedResources(AuthStorage *auth, Keyring *ring,
@@ -59,17 +62,37 @@ AbstractConnectionManager * SharedResources::getConnManager()
     return connManager;
 }
 
+void SharedResources::createCache(vlc_object_t *obj, HTTPConnectionManager *m)
+{
+    int64_t cachesize = var_InheritInteger(obj, "adaptive-cachesize");
+    if(cachesize <= 0)
+        return;
+    char *psz_dir = config_GetUserDir(VLC_CACHE_DIR);
+    if(!psz_dir)
+        return;
+    SegmentCache *cache = new SegmentCache(obj, std::string(psz_dir) + DIR_SEP "adaptive",
+                                           static_cast<uint64_t>(cachesize) << 20);
+    free(psz_dir);
+    if(cache->init())
+        m->setCache(cache);
+    else
+        delete cache;
+}
+
 SharedResources * SharedResources::createDefault(vlc_object_t *obj,
                                                  const std::string & playlisturl)
 {
     AuthStorage *auth = new AuthStorage(obj);
     Keyring *keyring = new Keyring(obj);
-    HTTPConnectionManager *m = new HTTPConnectionManager(obj);
+    unsigned maxdownloads = var_InheritInteger(obj, "adaptive-maxdownloads");
+    HTTPConnectionManager *m = new HTTPConnectionManager(obj, maxdownloads);
     if(!var_InheritBool(obj, "adaptive-use-access")) /* only use http from access */
         m->addFactory(new LibVLCHTTPConnectionFactory(auth));
     m->addFactory(new StreamUrlConnectionFactory());
     ConnectionParams params(playlisturl);
     if(params.isLocal())
         m->setLocalConnectionsAllowed();
+    else
+        createCache(obj, m);
     return new SharedResources(auth, keyring, m);
 }
@@ -29,6 +29,7 @@ namespace adaptive
     {
         class AuthStorage;
         class AbstractConnectionManager;
+        class HTTPConnectionManager;
     }
 
     namespace encryption
@@ -51,6 +52,7 @@ namespace adaptive
             static SharedResources * createDefault(vlc_object_t *, const std::string &);
 
         private:
+            static void createCache(vlc_object_t *, HTTPConnectionManager *);
             AuthStorage *authStorage;
             Keyring *encryptionKeyring;
             AbstractConnectionManager *connManager;
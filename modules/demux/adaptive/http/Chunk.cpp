@@ -261,6 +261,15 @@ std::string HTTPChunkSource::getContentType() const
         return std::string();
 }
 
+time_t HTTPChunkSource::getExpiryTime() const
+{
+    mutex_locker locker {lock};
+    if(connection)
+        return connection->getExpiryTime();
+    else
+        return 0;
+}
+
 bool HTTPChunkSource::prepare()
 {
     if(prepared)
@@ -374,6 +383,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
             done = true;
             eof = true;
             avail.signal();
+            onDone(false);
             return;
         }
 
@@ -398,31 +408,37 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_tick_t latency;
     } rate = {0,0,0};
 
+    bool b_done = false;
+    bool b_complete = false;
+
     ssize_t ret = connection->read(p_block->p_buffer, readsize);
     if(ret <= 0)
     {
         block_Release(p_block);
         p_block = nullptr;
         mutex_locker locker {lock};
-        done = true;
+        done = b_done = true;
         downloadEndTime = vlc_tick_now();
         rate.size = buffered + consumed;
         rate.time = downloadEndTime - requestStartTime;
         rate.latency = responseTime - requestStartTime;
+        b_complete = (ret == 0 && (!contentLength || rate.size == contentLength));
     }
     else
     {
         p_block->i_buffer = (size_t) ret;
+        onBufferized(p_block);
         mutex_locker locker {lock};
         buffered += p_block->i_buffer;
         block_ChainLastAppend(&pp_tail, p_block);
         if((size_t) ret < readsize)
         {
-            done = true;
+            done = b_done = true;
             downloadEndTime = vlc_tick_now();
             rate.size = buffered + consumed;
             rate.time = downloadEndTime - requestStartTime;
             rate.latency = responseTime - requestStartTime;
+            b_complete = (!contentLength || rate.size == contentLength);
         }
     }
 
@@ -432,6 +448,9 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
                                         rate.time, rate.latency);
     }
 
+    if(b_done)
+        onDone(b_complete);
+
     avail.signal();
 }
 
@@ -521,7 +540,7 @@ block_t * HTTPChunkBufferedSource::read(size_t readsize)
 
 HTTPChunk::HTTPChunk(const std::string &url, AbstractConnectionManager *manager,
                      const adaptive::ID &id, ChunkType type, const BytesRange &range):
-    AbstractChunk(manager->makeSource(url, id, type, range))
+    AbstractChunk(manager->makeSource(url, id, type, range, false))
 {
     manager->start(source);
 }
@@ -123,6 +123,7 @@ namespace adaptive
                 virtual size_t      getBytesRead    () const  override;
                 virtual std::string getContentType  () const  override;
                 virtual void        recycle() override;
+                time_t              getExpiryTime   () const;
 
                 static const size_t CHUNK_SIZE = 32768;
 
@@ -167,6 +168,8 @@ namespace adaptive
                 bool               isDone() const;
                 void               hold();
                 void               release();
+                virtual void       onBufferized(const block_t *) {}
+                virtual void       onDone(bool) {}
 
             private:
                 block_t            *p_head; /* read cache buffer */
@@ -25,27 +25,37 @@
 
 #include <vlc_threads.h>
 
-#include <atomic>
+#include <algorithm>
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Worker::Worker(Downloader *d)
 {
-    killed = false;
+    downloader = d;
     thread_handle_valid = false;
-    current = nullptr;
     cancel_current = false;
+    current = nullptr;
+}
+
+Downloader::Downloader(unsigned count)
+{
+    killed = false;
+    for(unsigned i=0; i<std::max(count, 1U); i++)
+        workers.push_back(new Worker(this));
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    for(Worker *worker : workers)
     {
-        return false;
+        if(!worker->thread_handle_valid &&
+           vlc_clone(&worker->thread_handle, downloaderThread,
+                     static_cast<void *>(worker), VLC_THREAD_PRIORITY_INPUT))
+        {
+            return false;
+        }
+        worker->thread_handle_valid = true;
     }
-    thread_handle_valid = true;
     return true;
 }
 
@@ -53,15 +63,19 @@ Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, nullptr);
+    for(Worker *worker : workers)
+    {
+        if(worker->thread_handle_valid)
+            vlc_join(worker->thread_handle, nullptr);
+        delete worker;
+    }
 }
 
 void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
 void Downloader::schedule(HTTPChunkBufferedSource *source)
@@ -75,9 +89,13 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    for(;;)
     {
-        cancel_current = true;
+        auto it = std::find_if(workers.begin(), workers.end(),
+                               [source](const Worker *w){ return w->current == source; });
+        if(it == workers.end())
+            break;
+        (*it)->cancel_current = true;
         updated_cond.wait(lock);
     }
 
@@ -88,20 +106,70 @@ void Downloader::cancel(HTTPChunkBufferedSource *source)
     }
 }
 
+void Downloader::updateBufferingLevel(const ID &id, vlc_tick_t level)
+{
+    vlc::threads::mutex_locker locker {lock};
+    bufferingLevels[id] = level;
+}
+
+bool Downloader::isActive(const HTTPChunkBufferedSource *source) const
+{
+    for(const Worker *worker : workers)
+        if(worker->current == source)
+            return true;
+    return false;
+}
+
+unsigned Downloader::getActiveCount(const ID &id) const
+{
+    unsigned count = 0;
+    for(const Worker *worker : workers)
+        if(worker->current && worker->current->sourceid == id)
+            count++;
+    return count;
+}
+
+HTTPChunkBufferedSource * Downloader::getNextChunk() const
+{
+    /* Pick the oldest chunk from the least served stream,
+     * then from the stream with the lowest buffering level */
+    HTTPChunkBufferedSource *next = nullptr;
+    unsigned nextActive = 0;
+    vlc_tick_t nextLevel = 0;
+    for(HTTPChunkBufferedSource *source : chunks)
+    {
+        if(isActive(source))
+            continue;
+
+        const unsigned active = getActiveCount(source->sourceid);
+        auto it = bufferingLevels.find(source->sourceid);
+        const vlc_tick_t level = (it != bufferingLevels.end()) ? (*it).second : 0;
+        if(!next || active < nextActive ||
+           (active == nextActive && level < nextLevel))
+        {
+            next = source;
+            nextActive = active;
+            nextLevel = level;
+        }
+    }
+    return next;
+}
+
 void * Downloader::downloaderThread(void *opaque)
 {
-    Downloader *instance = static_cast<Downloader *>(opaque);
-    instance->Run();
+    Worker *worker = static_cast<Worker *>(opaque);
+    worker->downloader->Run(worker);
     return nullptr;
 }
 
-void Downloader::Run()
+void Downloader::Run(Worker *worker)
 {
     while(1)
     {
         lock.lock();
 
-        while(chunks.empty() && !killed)
+        HTTPChunkBufferedSource *source = nullptr;
+        while(!killed && !(source = getNextChunk()))
             wait_cond.wait(lock);
 
         if(killed)
@@ -110,18 +178,19 @@ void Downloader::Run()
             break;
         }
 
-        current = chunks.front();
+        worker->current = source;
         lock.unlock();
-        current->bufferize(HTTPChunkSource::CHUNK_SIZE);
+        source->bufferize(HTTPChunkSource::CHUNK_SIZE);
         lock.lock();
-        if(current->isDone() || cancel_current)
+        if(source->isDone() || worker->cancel_current)
         {
-            chunks.pop_front();
-            current->release();
+            chunks.remove(source);
+            source->release();
         }
-        cancel_current = false;
-        current = nullptr;
-        updated_cond.signal();
+        worker->cancel_current = false;
+        worker->current = nullptr;
+        updated_cond.broadcast();
+        wait_cond.signal();
         lock.unlock();
     }
 }
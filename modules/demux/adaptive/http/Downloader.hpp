@@ -25,6 +25,8 @@
 #include <vlc_common.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <map>
+#include <vector>
 
 namespace adaptive
 {
@@ -35,25 +37,37 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
                 void cancel(HTTPChunkBufferedSource *);
+                void updateBufferingLevel(const ID &, vlc_tick_t);
 
             private:
+                class Worker
+                {
+                    public:
+                        Worker(Downloader *);
+                        Downloader *downloader;
+                        vlc_thread_t thread_handle;
+                        bool thread_handle_valid;
+                        bool cancel_current;
+                        HTTPChunkBufferedSource *current;
+                };
                 static void * downloaderThread(void *);
-                void Run();
+                void Run(Worker *);
                 void kill();
-                vlc_thread_t thread_handle;
+                HTTPChunkBufferedSource * getNextChunk() const;
+                unsigned getActiveCount(const ID &) const;
+                bool isActive(const HTTPChunkBufferedSource *) const;
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
                 bool         killed;
-                bool         cancel_current;
+                std::vector<Worker *> workers;
                 std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
+                std::map<ID, vlc_tick_t> bufferingLevels;
         };
 
     }
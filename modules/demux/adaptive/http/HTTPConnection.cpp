@@ -46,6 +46,7 @@ AbstractConnection::AbstractConnection(vlc_object_t *p_object_)
     available = true;
     bytesRead = 0;
     contentLength = 0;
+    expiryTime = 0;
 }
 
 AbstractConnection::~AbstractConnection()
@@ -78,6 +79,11 @@ const std::string & AbstractConnection::getContentType() const
     return contentType;
 }
 
+time_t AbstractConnection::getExpiryTime() const
+{
+    return expiryTime;
+}
+
 const ConnectionParams & AbstractConnection::getRedirection() const
 {
     return locationparams;
@@ -273,6 +279,7 @@ void LibVLCHTTPConnection::reset()
     }
     bytesRange = BytesRange();
     contentType = std::string();
+    expiryTime = 0;
     bytesRead = 0;
     contentLength = 0;
 }
@@ -286,6 +293,45 @@ bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
             params.getPort() == params_.getPort());
 }
 
+/* Returns until when the response can be reused without validation,
+ * following IETF RFC7234 §4.2, or 0 if it cannot */
+static time_t getResponseExpiryTime(const struct vlc_http_msg *resp)
+{
+    if(vlc_http_msg_get_token(resp, "Cache-Control", "no-store") ||
+       vlc_http_msg_get_token(resp, "Cache-Control", "no-cache") ||
+       vlc_http_msg_get_token(resp, "Pragma", "no-cache"))
+        return 0;
+
+    const time_t now = time(nullptr);
+    time_t date = vlc_http_msg_get_atime(resp);
+    if(date == (time_t)-1)
+        date = now;
+
+    const char *str = vlc_http_msg_get_token(resp, "Cache-Control", "max-age");
+    if(str)
+    {
+        str += strlen("max-age");
+        str += strspn(str, " \t");
+        if(*str != '=')
+            return 0;
+        str += 1 + strspn(str + 1, " \t\"");
+        char *end;
+        unsigned long age = strtoul(str, &end, 10);
+        return (end != str && age > 0) ? now + age : 0;
+    }
+
+    time_t expires = vlc_http_msg_get_time(resp, "Expires");
+    if(expires != (time_t)-1)
+        return (expires > date) ? now + (expires - date) : 0;
+
+    /* heuristic freshness: a tenth of the time since the last change */
+    time_t modified = vlc_http_msg_get_mtime(resp);
+    if(modified != (time_t)-1 && modified < date)
+        return now + (date - modified) / 10;
+
+    return 0;
+}
+
 RequestStatus LibVLCHTTPConnection::request(const std::string &path,
                                             const BytesRange &range)
 {
@@ -392,6 +438,8 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     if(s)
         contentType = std::string(s);
 
+    expiryTime = getResponseExpiryTime(source->http_res->response);
+
     s = vlc_http_msg_get_header(source->http_res->response, "Content-Encoding");
     if(s && stream && (strstr(s, "deflate") || strstr(s, "gzip")))
     {
@@ -441,6 +489,7 @@ void StreamUrlConnection::reset()
     bytesRead = 0;
     contentLength = 0;
     contentType = std::string();
+    expiryTime = 0;
     bytesRange = BytesRange();
 }
 
@@ -29,6 +29,7 @@
 #include "HTTPConnection.hpp"
 #include "ConnectionParams.hpp"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
@@ -60,6 +61,11 @@ void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid,
     }
 }
 
+void AbstractConnectionManager::updateBufferingLevel(const adaptive::ID &, vlc_tick_t)
+{
+
+}
+
 void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
 {
     rateObserver = obs;
@@ -70,12 +76,14 @@ void AbstractConnectionManager::deleteSource(AbstractChunkSource *source)
     delete source;
 }
 
-HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
+HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_,
+                                                 unsigned maxdownloads)
     : AbstractConnectionManager( p_object_ ),
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new Downloader();
+    cache = nullptr;
+    downloader = new Downloader(maxdownloads);
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
@@ -85,6 +93,7 @@ HTTPConnectionManager::~HTTPConnectionManager   ()
 {
     delete downloader;
     delete downloaderhp;
+    delete cache;
     this->closeAllConnections();
     while(!factories.empty())
     {
@@ -160,14 +169,26 @@ AbstractConnection * HTTPConnectionManager::getConnection(ConnectionParams &para
 
 AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
                                                        const ID &id, ChunkType type,
-                                                       const BytesRange &range)
+                                                       const BytesRange &range,
+                                                       bool cacheable)
 {
     switch(type)
     {
         case ChunkType::Init:
         case ChunkType::Index:
         case ChunkType::Segment:
-
+            if(cache && cacheable)
+            {
+                std::string contentType;
+                size_t size;
+                FILE *file = cache->open(SegmentCache::makeKey(url, range),
+                                         contentType, &size);
+                if(file)
+                    return new CachedChunkSource(this, file, type, range,
+                                                 contentType, size);
+                return new CachingChunkSource(url, this, id, type, range, cache);
+            }
+            /* fallthrough */
         case ChunkType::Key:
         case ChunkType::Playlist:
         default:
@@ -209,6 +230,11 @@ void HTTPConnectionManager::cancel(AbstractChunkSource *source)
         getDownloadQueue(src)->cancel(src);
 }
 
+void HTTPConnectionManager::updateBufferingLevel(const adaptive::ID &id, vlc_tick_t level)
+{
+    downloader->updateBufferingLevel(id, level);
+}
+
 void HTTPConnectionManager::setLocalConnectionsAllowed()
 {
     localAllowed = true;
@@ -218,3 +244,9 @@ void HTTPConnectionManager::addFactory(AbstractConnectionFactory *factory)
 {
     factories.push_back(factory);
 }
+
+void HTTPConnectionManager::setCache(SegmentCache *cache_)
+{
+    delete cache;
+    cache = cache_;
+}
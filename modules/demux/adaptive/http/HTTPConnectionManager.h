@@ -43,6 +43,7 @@ namespace adaptive
         class AbstractConnection;
         class Downloader;
         class AbstractChunkSource;
+        class SegmentCache;
         enum class ChunkType;
 
         class AbstractConnectionManager : public IDownloadRateObserver
@@ -54,7 +55,8 @@ namespace adaptive
                 virtual AbstractConnection * getConnection(ConnectionParams &) = 0;
                 virtual AbstractChunkSource *makeSource(const std::string &,
                                                         const ID &, ChunkType,
-                                                        const BytesRange &) = 0;
+                                                        const BytesRange &,
+                                                        bool) = 0;
                 virtual void recycleSource(AbstractChunkSource *) = 0;
 
                 virtual void start(AbstractChunkSource *) = 0;
@@ -62,6 +64,7 @@ namespace adaptive
 
                 virtual void updateDownloadRate(const ID &, size_t,
                                                 vlc_tick_t, vlc_tick_t) override;
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t);
                 void setDownloadRateObserver(IDownloadRateObserver *);
 
             protected:
@@ -75,25 +78,29 @@ namespace adaptive
         class HTTPConnectionManager : public AbstractConnectionManager
         {
             public:
-                HTTPConnectionManager           (vlc_object_t *p_object);
+                HTTPConnectionManager           (vlc_object_t *p_object, unsigned = 1);
                 virtual ~HTTPConnectionManager  ();
 
                 virtual void    closeAllConnections ()  override;
                 virtual AbstractConnection * getConnection(ConnectionParams &)  override;
                 virtual AbstractChunkSource *makeSource(const std::string &,
                                                         const ID &, ChunkType,
-                                                        const BytesRange &) override;
+                                                        const BytesRange &,
+                                                        bool) override;
                 virtual void recycleSource(AbstractChunkSource *) override;
 
                 virtual void start(AbstractChunkSource *)  override;
                 virtual void cancel(AbstractChunkSource *)  override;
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t) override;
                 void         setLocalConnectionsAllowed();
                 void         addFactory(AbstractConnectionFactory *);
+                void         setCache(SegmentCache *);
 
             private:
                 void    releaseAllConnections ();
                 Downloader                                         *downloader;
                 Downloader                                         *downloaderhp;
+                SegmentCache                                       *cache;
                 vlc_mutex_t                                         lock;
                 std::vector<AbstractConnection *>                   connectionPool;
                 std::list<AbstractConnectionFactory *>              factories;
@@ -0,0 +1,399 @@
+/*
+ * SegmentCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SegmentCache.hpp"
+#include "HTTPConnectionManager.h"
+
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <vector>
+#include <sys/stat.h>
+
+using namespace adaptive::http;
+using vlc::threads::mutex_locker;
+
+#define CACHE_FILE_EXT    ".seg"
+#define CACHE_PART_PREFIX "part-"
+
+SegmentCache::SegmentCache(vlc_object_t *obj, const std::string &dir, uint64_t size)
+{
+    p_obj = obj;
+    directory = dir;
+    maxsize = size;
+    totalsize = 0;
+}
+
+SegmentCache::~SegmentCache()
+{
+}
+
+std::string SegmentCache::makeKey(const std::string &url, const BytesRange &range)
+{
+    if(!range.isValid())
+        return url;
+    return url + "#" + std::to_string(range.getStartByte()) +
+                 "-" + std::to_string(range.getEndByte());
+}
+
+std::string SegmentCache::getFilename(const std::string &key) const
+{
+    vlc_hash_md5_t md5;
+    uint8_t digest[VLC_HASH_MD5_DIGEST_SIZE];
+    char hex[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_Init(&md5);
+    vlc_hash_md5_Update(&md5, key.c_str(), key.length());
+    vlc_hash_md5_Finish(&md5, digest, sizeof(digest));
+    vlc_hex_encode_binary(digest, sizeof(digest), hex);
+    return directory + DIR_SEP + hex + CACHE_FILE_EXT;
+}
+
+bool SegmentCache::readHeader(FILE *file, std::string &key, std::string &contentType,
+                              time_t *expiry) const
+{
+    char *line = nullptr;
+    size_t linesize = 0;
+    std::string fields[3];
+    for(int i=0; i<3; i++)
+    {
+        ssize_t len = getline(&line, &linesize, file);
+        if(len <= 0 || line[len - 1] != '\n')
+        {
+            free(line);
+            return false;
+        }
+        fields[i].assign(line, len - 1);
+    }
+    free(line);
+    key = fields[0];
+    contentType = fields[1];
+    char *end;
+    *expiry = strtoll(fields[2].c_str(), &end, 10);
+    return !key.empty() && !fields[2].empty() && *end == '\0';
+}
+
+bool SegmentCache::init()
+{
+    if(vlc_mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST)
+    {
+        msg_Warn(p_obj, "cannot create segments cache directory %s", directory.c_str());
+        return false;
+    }
+
+    DIR *dir = vlc_opendir(directory.c_str());
+    if(!dir)
+        return false;
+
+    std::vector<std::pair<time_t, Entry>> found;
+    const time_t now = time(nullptr);
+    const char *psz_name;
+    while((psz_name = vlc_readdir(dir)) != nullptr)
+    {
+        const std::string name(psz_name);
+        const std::string filename = directory + DIR_SEP + name;
+        struct stat st;
+        if(vlc_stat(filename.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+            continue;
+
+        /* Leftovers from interrupted downloads */
+        if(name.compare(0, sizeof(CACHE_PART_PREFIX) - 1, CACHE_PART_PREFIX) == 0)
+        {
+            if(now - st.st_mtime > 3600)
+                vlc_unlink(filename.c_str());
+            continue;
+        }
+
+        if(name.length() <= sizeof(CACHE_FILE_EXT) - 1 ||
+           name.compare(name.length() - sizeof(CACHE_FILE_EXT) + 1,
+                        std::string::npos, CACHE_FILE_EXT) != 0)
+            continue;
+
+        FILE *file = vlc_fopen(filename.c_str(), "rb");
+        if(!file)
+            continue;
+        Entry entry;
+        std::string contentType;
+        time_t expiry;
+        bool b_valid = readHeader(file, entry.key, contentType, &expiry);
+        fclose(file);
+        if(!b_valid || expiry <= now || getFilename(entry.key) != filename)
+        {
+            vlc_unlink(filename.c_str());
+            continue;
+        }
+        entry.filename = filename;
+        entry.size = st.st_size;
+        found.push_back(std::make_pair(st.st_mtime, entry));
+    }
+    closedir(dir);
+
+    /* Restore usage order from storage time */
+    std::sort(found.begin(), found.end(),
+              [](const std::pair<time_t, Entry> &a, const std::pair<time_t, Entry> &b)
+              { return a.first < b.first; });
+
+    mutex_locker locker {lock};
+    for(const auto &f : found)
+        insert(f.second);
+    evict();
+
+    msg_Dbg(p_obj, "segments cache %s: %zu entries, %" PRIu64 "/%" PRIu64 " KiB",
+            directory.c_str(), entries.size(), totalsize / 1024, maxsize / 1024);
+    return true;
+}
+
+void SegmentCache::insert(const Entry &entry)
+{
+    auto it = index.find(entry.key);
+    if(it != index.end())
+    {
+        totalsize -= (*it->second).size;
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    entries.push_front(entry);
+    index[entry.key] = entries.begin();
+    totalsize += entry.size;
+}
+
+void SegmentCache::evict()
+{
+    while(totalsize > maxsize && !entries.empty())
+    {
+        const Entry &entry = entries.back();
+        vlc_unlink(entry.filename.c_str());
+        totalsize -= entry.size;
+        index.erase(entry.key);
+        entries.pop_back();
+    }
+}
+
+FILE * SegmentCache::open(const std::string &key, std::string &contentType, size_t *size)
+{
+    mutex_locker locker {lock};
+    auto it = index.find(key);
+    if(it == index.end())
+        return nullptr;
+
+    Entry &entry = *it->second;
+    std::string storedkey;
+    time_t expiry;
+    FILE *file = vlc_fopen(entry.filename.c_str(), "rb");
+    if(!file || !readHeader(file, storedkey, contentType, &expiry) ||
+       storedkey != key || expiry <= time(nullptr))
+    {
+        /* expired, or removed or corrupted behind our back */
+        if(file)
+            fclose(file);
+        vlc_unlink(entry.filename.c_str());
+        totalsize -= entry.size;
+        entries.erase(it->second);
+        index.erase(it);
+        return nullptr;
+    }
+
+    long headersize = ftell(file);
+    *size = (headersize >= 0 && (uint64_t)headersize < entry.size)
+          ? entry.size - headersize : 0;
+    entries.splice(entries.begin(), entries, it->second);
+    return file;
+}
+
+FILE * SegmentCache::create(const std::string &key, const std::string &contentType,
+                            time_t expiry, std::string &partname)
+{
+    if(key.find('\n') != std::string::npos || contentType.find('\n') != std::string::npos ||
+       expiry <= time(nullptr))
+        return nullptr;
+
+    std::string tmpl = directory + DIR_SEP CACHE_PART_PREFIX "XXXXXX";
+    std::vector<char> psz(tmpl.begin(), tmpl.end());
+    psz.push_back('\0');
+    int fd = vlc_mkstemp(psz.data());
+    if(fd == -1)
+        return nullptr;
+    FILE *file = fdopen(fd, "wb");
+    if(!file)
+    {
+        vlc_close(fd);
+        vlc_unlink(psz.data());
+        return nullptr;
+    }
+    partname = psz.data();
+    if(fprintf(file, "%s\n%s\n%lld\n", key.c_str(), contentType.c_str(),
+               static_cast<long long>(expiry)) < 0)
+    {
+        store(file, partname, key, false);
+        return nullptr;
+    }
+    return file;
+}
+
+void SegmentCache::store(FILE *file, const std::string &partname,
+                         const std::string &key, bool b_complete)
+{
+    long size = ftell(file);
+    if(fclose(file) != 0 || size <= 0)
+        b_complete = false;
+
+    if(!b_complete)
+    {
+        vlc_unlink(partname.c_str());
+        return;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.filename = getFilename(key);
+    entry.size = size;
+
+    mutex_locker locker {lock};
+    if(vlc_rename(partname.c_str(), entry.filename.c_str()) != 0)
+    {
+        vlc_unlink(partname.c_str());
+        return;
+    }
+    insert(entry);
+    evict();
+}
+
+CachedChunkSource::CachedChunkSource(AbstractConnectionManager *manager, FILE *f,
+                                     ChunkType type, const BytesRange &range,
+                                     const std::string &contentType_, size_t size) :
+    AbstractChunkSource(type, range)
+{
+    connManager = manager;
+    file = f;
+    contentType = contentType_;
+    contentLength = size;
+    consumed = 0;
+    eof = false;
+}
+
+CachedChunkSource::~CachedChunkSource()
+{
+    fclose(file);
+}
+
+block_t * CachedChunkSource::readBlock()
+{
+    return read(HTTPChunkSource::CHUNK_SIZE);
+}
+
+block_t * CachedChunkSource::read(size_t readsize)
+{
+    if(eof || !readsize)
+        return nullptr;
+
+    block_t *p_block = block_Alloc(readsize);
+    if(!p_block)
+    {
+        eof = true;
+        return nullptr;
+    }
+
+    p_block->i_buffer = fread(p_block->p_buffer, 1, readsize, file);
+    if(p_block->i_buffer < readsize)
+        eof = true;
+    if(p_block->i_buffer == 0)
+    {
+        block_Release(p_block);
+        return nullptr;
+    }
+    consumed += p_block->i_buffer;
+    return p_block;
+}
+
+bool CachedChunkSource::hasMoreData() const
+{
+    return !eof;
+}
+
+size_t CachedChunkSource::getBytesRead() const
+{
+    return consumed;
+}
+
+std::string CachedChunkSource::getContentType() const
+{
+    return contentType;
+}
+
+void CachedChunkSource::recycle()
+{
+    connManager->recycleSource(this);
+}
+
+CachingChunkSource::CachingChunkSource(const std::string &url,
+                                       AbstractConnectionManager *manager,
+                                       const adaptive::ID &sourceid,
+                                       ChunkType type, const BytesRange &range,
+                                       SegmentCache *cache_) :
+    HTTPChunkBufferedSource(url, manager, sourceid, type, range)
+{
+    cache = cache_;
+    key = SegmentCache::makeKey(url, range);
+    file = nullptr;
+    failed = false;
+}
+
+CachingChunkSource::~CachingChunkSource()
+{
+    /* stop the downloader before it can call us back */
+    connManager->cancel(this);
+    if(file)
+        cache->store(file, partname, key, false);
+}
+
+void CachingChunkSource::onBufferized(const block_t *p_block)
+{
+    if(failed)
+        return;
+
+    if(!file)
+    {
+        file = cache->create(key, getContentType(), getExpiryTime(), partname);
+        if(!file)
+        {
+            failed = true;
+            return;
+        }
+    }
+
+    if(fwrite(p_block->p_buffer, 1, p_block->i_buffer, file) != p_block->i_buffer)
+        failed = true;
+}
+
+void CachingChunkSource::onDone(bool b_complete)
+{
+    if(file)
+    {
+        cache->store(file, partname, key, b_complete && !failed);
+        file = nullptr;
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * SegmentCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SEGMENTCACHE_HPP
+#define SEGMENTCACHE_HPP
+
+#include "Chunk.h"
+
+#include <vlc_common.h>
+#include <vlc_cxx_helpers.hpp>
+
+#include <cstdio>
+#include <list>
+#include <map>
+#include <string>
+
+namespace adaptive
+{
+    namespace http
+    {
+        /* Persistent storage of downloaded segments, keyed by url and range.
+         * Entries are only served until the expiry time of their response.
+         * Least recently used entries are removed when over size limit. */
+        class SegmentCache
+        {
+            public:
+                SegmentCache(vlc_object_t *, const std::string &, uint64_t);
+                ~SegmentCache();
+                bool init();
+                FILE * open(const std::string &, std::string &, size_t *);
+                FILE * create(const std::string &, const std::string &, time_t,
+                              std::string &);
+                void store(FILE *, const std::string &, const std::string &, bool);
+                static std::string makeKey(const std::string &, const BytesRange &);
+
+            private:
+                class Entry
+                {
+                    public:
+                        std::string key;
+                        std::string filename;
+                        uint64_t size;
+                };
+                std::string getFilename(const std::string &) const;
+                bool readHeader(FILE *, std::string &, std::string &, time_t *) const;
+                void insert(const Entry &);
+                void evict();
+                vlc_object_t *p_obj;
+                std::string directory;
+                uint64_t maxsize;
+                uint64_t totalsize;
+                std::list<Entry> entries; /* most recently used first */
+                std::map<std::string, std::list<Entry>::iterator> index;
+                vlc::threads::mutex lock;
+        };
+
+        /* Serves a previously stored segment */
+        class CachedChunkSource : public AbstractChunkSource
+        {
+            friend class HTTPConnectionManager;
+
+            public:
+                virtual ~CachedChunkSource();
+                virtual block_t *   readBlock       () override;
+                virtual block_t *   read            (size_t) override;
+                virtual bool        hasMoreData     () const override;
+                virtual size_t      getBytesRead    () const override;
+                virtual std::string getContentType  () const override;
+                virtual void        recycle() override;
+
+            protected:
+                CachedChunkSource(AbstractConnectionManager *, FILE *,
+                                  ChunkType, const BytesRange &,
+                                  const std::string &, size_t);
+
+            private:
+                AbstractConnectionManager *connManager;
+                FILE               *file;
+                std::string         contentType;
+                size_t              consumed;
+                bool                eof;
+        };
+
+        /* Downloads a segment and stores it once complete */
+        class CachingChunkSource : public HTTPChunkBufferedSource
+        {
+            friend class HTTPConnectionManager;
+
+            public:
+                virtual ~CachingChunkSource();
+
+            protected:
+                CachingChunkSource(const std::string &url, AbstractConnectionManager *,
+                                   const ID &, ChunkType, const BytesRange &,
+                                   SegmentCache *);
+                virtual void       onBufferized(const block_t *) override;
+                virtual void       onDone(bool) override;
+
+            private:
+                SegmentCache       *cache;
+                std::string         key;
+                std::string         partname;
+                FILE               *file;
+                bool                failed;
+        };
+    }
+}
+
+#endif // SEGMENTCACHE_HPP
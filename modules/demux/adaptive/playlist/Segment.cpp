@@ -89,10 +89,12 @@ SegmentChunk* ISegment::toChunk(SharedResources *res, AbstractConnectionManager
         chunkType = ChunkType::Index;
     else
         chunkType = ChunkType::Segment;
+    /* segments of live playlists are not worth storing */
     AbstractChunkSource *source = connManager->makeSource(url,
                                                           rep->getAdaptationSet()->getID(),
                                                           chunkType,
-                                                          range);
+                                                          range,
+                                                          !rep->getPlaylist()->isLive());
     if(source)
     {
         SegmentChunk *chunk = createChunk(source, rep);
@@ -192,6 +194,11 @@ void ISegment::setEncryption(CommonEncryption &e)
     encryption = e;
 }
 
+const CommonEncryption & ISegment::getEncryption() const
+{
+    return encryption;
+}
+
 void ISegment::setDisplayTime(vlc_tick_t t)
 {
     displayTime = t;
@@ -75,6 +75,7 @@ namespace adaptive
                 virtual bool                            contains        (size_t byte) const;
                 virtual int                             compare         (ISegment *) const;
                 void                                    setEncryption   (CommonEncryption &);
+                const CommonEncryption &                getEncryption   () const;
                 void                                    setDisplayTime  (vlc_tick_t);
                 vlc_tick_t                              getDisplayTime  () const;
                 Property<stime_t>       startTime;
@@ -28,7 +28,7 @@
 #include <vlc_block.h>
 #include <vlc_meta.h>
 #include <algorithm>
-#include <set>
+#include <cassert>
 
 using namespace adaptive;
 
@@ -42,6 +42,54 @@ enum
     ES_OUT_PRIVATE_COMMAND_MILESTONE,
 };
 
+CommandsPool::CommandsPool( size_t size, size_t max )
+{
+    objectsize = size;
+    maxfree = max;
+    outstanding = 0;
+}
+
+CommandsPool::~CommandsPool()
+{
+    assert( outstanding == 0 );
+    for( Header *h : freelist )
+        ::operator delete( h );
+}
+
+void * CommandsPool::allocate( size_t size )
+{
+    assert( size <= objectsize );
+    Header *h;
+    if( !freelist.empty() )
+    {
+        h = freelist.back();
+        freelist.pop_back();
+    }
+    else
+    {
+        h = static_cast<Header *>(::operator new( sizeof(Header) + objectsize,
+                                                  std::nothrow ));
+        if( !h )
+            return nullptr;
+    }
+    h->pool = this;
+    outstanding++;
+    return h + 1;
+}
+
+void CommandsPool::release( void *p )
+{
+    if( !p )
+        return;
+    Header *h = static_cast<Header *>(p) - 1;
+    CommandsPool *pool = h->pool;
+    pool->outstanding--;
+    if( pool->freelist.size() < pool->maxfree )
+        pool->freelist.push_back( h );
+    else
+        ::operator delete( h );
+}
+
 AbstractCommand::AbstractCommand( int type_ )
 {
     type = type_;
@@ -91,6 +139,21 @@ void EsOutSendCommand::Execute()
     p_block = nullptr;
 }
 
+void * EsOutSendCommand::operator new( size_t size, CommandsPool &pool ) noexcept
+{
+    return pool.allocate( size );
+}
+
+void EsOutSendCommand::operator delete( void *p )
+{
+    CommandsPool::release( p );
+}
+
+void EsOutSendCommand::operator delete( void *p, CommandsPool & )
+{
+    CommandsPool::release( p );
+}
+
 vlc_tick_t EsOutSendCommand::getTime() const
 {
     if( likely(p_block) )
@@ -197,7 +260,7 @@ void EsOutMilestoneCommand::Execute()
 
 EsOutSendCommand * CommandsFactory::createEsOutSendCommand( AbstractFakeESOutID *id, block_t *p_block ) const
 {
-    return new (std::nothrow) EsOutSendCommand( id, p_block );
+    return new (sendpool) EsOutSendCommand( id, p_block );
 }
 
 EsOutDelCommand * CommandsFactory::createEsOutDelCommand( AbstractFakeESOutID *id ) const
@@ -334,22 +397,44 @@ void CommandsQueue::Schedule( AbstractCommand *command, EsType )
     {
         delete command;
     }
-    else if( command->getType() == ES_OUT_SET_GROUP_PCR )
-    {
-        bufferinglevel = command->getTime();
-        LockedCommit();
-        commands.push_back( Queueentry(nextsequence++, command) );
-    }
     else
     {
-        incoming.push_back( Queueentry(nextsequence++, command) );
+        /* Reuse list nodes from already processed commands */
+        if( freeentries.empty() )
+            freeentries.emplace_back();
+        freeentries.front() = Queueentry(nextsequence++, command);
+
+        if( command->getType() == ES_OUT_SET_GROUP_PCR )
+        {
+            bufferinglevel = command->getTime();
+            LockedCommit();
+            commands.splice( commands.end(), freeentries, freeentries.begin() );
+        }
+        else
+        {
+            incoming.splice( incoming.end(), freeentries, freeentries.begin() );
+        }
     }
 }
 
+bool CommandsQueue::isDisabled( const void *id ) const
+{
+    return std::find( disabled_esids.begin(), disabled_esids.end(), id ) != disabled_esids.end();
+}
+
+void CommandsQueue::Recycle( std::list<Queueentry> &list )
+{
+    /* Keep list nodes for the next scheduled commands */
+    delete list.front().second;
+    if( freeentries.size() < MAX_FREE_ENTRIES )
+        freeentries.splice( freeentries.end(), list, list.begin() );
+    else
+        list.pop_front();
+}
+
 vlc_tick_t CommandsQueue::Process( vlc_tick_t barrier )
 {
     vlc_tick_t lastdts = barrier;
-    std::set<const void *> disabled_esids;
     bool b_datasent = false;
 
     /* We need to filter the current commands list
@@ -365,10 +450,10 @@ vlc_tick_t CommandsQueue::Process( vlc_tick_t barrier )
 
     in.splice( in.end(), commands );
 
+    /* Entries are only moved between lists, no allocation occurs */
     while( !in.empty() )
     {
-        Queueentry entry = in.front();
-        AbstractCommand *command = entry.second;
+        AbstractCommand *command = in.front().second;
 
         if( command->getType() == ES_OUT_PRIVATE_COMMAND_DEL && b_datasent )
             break;
@@ -379,36 +464,36 @@ vlc_tick_t CommandsQueue::Process( vlc_tick_t barrier )
         if(command->getType() == ES_OUT_SET_GROUP_PCR && command->getTime() > barrier )
             break;
 
-        in.pop_front();
         b_datasent = true;
 
         if( command->getType() == ES_OUT_PRIVATE_COMMAND_SEND )
         {
-            EsOutSendCommand *sendcommand = dynamic_cast<EsOutSendCommand *>(command);
+            EsOutSendCommand *sendcommand = static_cast<EsOutSendCommand *>(command);
             /* We need a stream identifier to send NON DATED data following DATA for the same ES */
-            const void *id = (sendcommand) ? sendcommand->esIdentifier() : 0;
+            const void *id = sendcommand->esIdentifier();
 
             /* Not for now */
             if( command->getTime() > barrier ) /* Not for now */
             {
                 /* ensure no more non dated for that ES is sent
                  * since we're sure that data is above barrier */
-                disabled_esids.insert( id );
-                commands.push_back( entry );
+                if( !isDisabled( id ) )
+                    disabled_esids.push_back( id );
+                commands.splice( commands.end(), in, in.begin() );
             }
             else if( command->getTime() == VLC_TICK_INVALID )
             {
-                if( disabled_esids.find( id ) == disabled_esids.end() )
-                    output.push_back( entry );
+                if( !isDisabled( id ) )
+                    output.splice( output.end(), in, in.begin() );
                 else
-                    commands.push_back( entry );
+                    commands.splice( commands.end(), in, in.begin() );
             }
             else /* Falls below barrier, send */
             {
-                output.push_back( entry );
+                output.splice( output.end(), in, in.begin() );
             }
         }
-        else output.push_back( entry ); /* will discard below */
+        else output.splice( output.end(), in, in.begin() ); /* will discard below */
     }
 
     /* push remaining ones if broke above */
@@ -421,7 +506,6 @@ vlc_tick_t CommandsQueue::Process( vlc_tick_t barrier )
     while( !output.empty() )
     {
         AbstractCommand *command = output.front().second;
-        output.pop_front();
 
         if( command->getType() == ES_OUT_PRIVATE_COMMAND_SEND )
         {
@@ -431,9 +515,10 @@ vlc_tick_t CommandsQueue::Process( vlc_tick_t barrier )
         }
 
         command->Execute();
-        delete command;
+        Recycle( output );
     }
     pcr = lastdts; /* Warn! no PCR update/lock release until execution */
+    disabled_esids.clear();
 
 
     return lastdts;
@@ -455,10 +540,7 @@ void CommandsQueue::Abort( bool b_reset )
 {
     commands.splice( commands.end(), incoming );
     while( !commands.empty() )
-    {
-        delete commands.front().second;
-        commands.pop_front();
-    }
+        Recycle( commands );
 
     if( b_reset )
     {
@@ -26,12 +26,36 @@
 #include <vlc_es.h>
 
 #include <atomic>
+#include <cstddef>
 #include <list>
+#include <vector>
 
 namespace adaptive
 {
     class AbstractFakeEsOut;
 
+    /* Recycles storage of the most frequent commands.
+     * Not thread safe: commands are allocated and released
+     * under the FakeESOut lock */
+    class CommandsPool
+    {
+        public:
+            CommandsPool(size_t, size_t = 512);
+            ~CommandsPool();
+            void * allocate(size_t);
+            static void release(void *);
+
+        private:
+            struct alignas(std::max_align_t) Header
+            {
+                CommandsPool *pool;
+            };
+            size_t objectsize;
+            size_t maxfree;
+            size_t outstanding;
+            std::vector<Header *> freelist;
+    };
+
     class AbstractCommand
     {
         friend class CommandsFactory;
@@ -63,6 +87,9 @@ namespace adaptive
             virtual ~EsOutSendCommand();
             virtual void Execute( ) override;
             virtual vlc_tick_t getTime() const override;
+            static void * operator new( size_t, CommandsPool & ) noexcept;
+            static void operator delete( void * );
+            static void operator delete( void *, CommandsPool & );
 
         protected:
             EsOutSendCommand( AbstractFakeESOutID *, block_t * );
@@ -161,6 +188,9 @@ namespace adaptive
             virtual EsOutDestroyCommand * createEsOutDestroyCommand() const;
             virtual EsOutMetaCommand * createEsOutMetaCommand( AbstractFakeEsOut *, int, const vlc_meta_t * ) const;
             virtual EsOutMilestoneCommand * createEsOutMilestoneCommand( AbstractFakeEsOut * ) const;
+
+        private:
+            mutable CommandsPool sendpool { sizeof(EsOutSendCommand) };
     };
 
     using Queueentry = std::pair<uint64_t, AbstractCommand *>;
@@ -211,11 +241,16 @@ namespace adaptive
         private:
             void LockedCommit();
             void LockedSetDraining();
+            void Recycle( std::list<Queueentry> & );
+            bool isDisabled( const void * ) const;
             std::list<Queueentry> incoming;
             std::list<Queueentry> commands;
+            std::list<Queueentry> freeentries;
+            std::vector<const void *> disabled_esids;
             vlc_tick_t bufferinglevel;
             vlc_tick_t pcr;
             uint64_t nextsequence;
+            static const size_t MAX_FREE_ENTRIES = 4096;
     };
 }
 
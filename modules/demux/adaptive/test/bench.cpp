@@ -0,0 +1,442 @@
+/*****************************************************************************
+ * bench.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Replays bandwidth traces against each adaptation logic, on a simulated
+ * clock, and reports startup delay, rebuffering, average bitrate and
+ * representation switches.
+ *
+ * usage: adaptive_bench [trace file...]
+ *
+ * Trace files contain one "<duration ms> <bandwidth kbps>" step per line,
+ * replayed in a loop. Built-in synthetic traces are used when none is given.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+
+#include "../playlist/BasePlaylist.hpp"
+#include "../playlist/BasePeriod.h"
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../playlist/SegmentList.h"
+#include "../playlist/Segment.h"
+#include "../logic/BufferingLogic.hpp"
+#include "../logic/RateBasedAdaptationLogic.h"
+#include "../logic/PredictiveAdaptationLogic.hpp"
+#include "../logic/NearOptimalAdaptationLogic.hpp"
+#include "../http/HTTPConnection.hpp"
+#include "../http/ConnectionParams.hpp"
+#include "../SegmentTracker.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern const char vlc_module_name[] = "adaptive_bench";
+
+using namespace adaptive;
+using namespace adaptive::http;
+using namespace adaptive::logic;
+using namespace adaptive::playlist;
+
+namespace
+{
+    constexpr vlc_tick_t SEGMENT_DURATION = VLC_TICK_FROM_SEC(4);
+    constexpr unsigned   SEGMENTS_COUNT = 150;
+    constexpr size_t     READ_SIZE = 32 * 1024;
+    const uint64_t       LADDER[] = { 250000, 500000, 1000000, 2500000, 5000000, 8000000 };
+
+    class BenchPlaylist : public BasePlaylist
+    {
+        public:
+            BenchPlaylist() : BasePlaylist(nullptr) {}
+            virtual ~BenchPlaylist() {}
+            virtual bool isLive() const override { return false; }
+            virtual bool isLowLatency() const override { return false; }
+    };
+
+    /* Network bandwidth over time, looped */
+    class Trace
+    {
+        public:
+            bool load(const std::string &path)
+            {
+                std::ifstream file(path);
+                std::string line;
+                while(std::getline(file, line))
+                {
+                    std::istringstream ss(line);
+                    uint64_t ms, kbps;
+                    if(line.empty() || line[0] == '#' || !(ss >> ms >> kbps) || !ms)
+                        continue;
+                    addStep(VLC_TICK_FROM_MS(ms), kbps * 1000);
+                }
+                name = path;
+                return !steps.empty();
+            }
+
+            void addStep(vlc_tick_t duration, uint64_t bps)
+            {
+                steps.push_back(Step{duration, std::max<uint64_t>(bps, 1)});
+                length += duration;
+            }
+
+            /* time needed to transfer size bytes starting at now */
+            vlc_tick_t transferTime(vlc_tick_t now, size_t size) const
+            {
+                vlc_tick_t elapsed = 0;
+                double bits = size * 8.0;
+                vlc_tick_t pos = now % length;
+                size_t i = 0;
+                while(pos >= steps[i].duration)
+                    pos -= steps[i++].duration;
+                for(;;)
+                {
+                    const Step &step = steps[i];
+                    const vlc_tick_t remain = step.duration - pos;
+                    const double stepbits = (double) step.bps * remain / CLOCK_FREQ;
+                    if(stepbits >= bits)
+                        return elapsed + (vlc_tick_t)(bits * CLOCK_FREQ / step.bps) + 1;
+                    bits -= stepbits;
+                    elapsed += remain;
+                    pos = 0;
+                    i = (i + 1) % steps.size();
+                }
+            }
+
+            std::string name;
+
+        private:
+            struct Step
+            {
+                vlc_tick_t duration;
+                uint64_t bps;
+            };
+            std::vector<Step> steps;
+            vlc_tick_t length = 0;
+    };
+
+    /* Serves synthetic segments, whose size is given in the request path,
+     * at the trace bandwidth and on the shared simulated clock */
+    class TraceConnection : public AbstractConnection
+    {
+        public:
+            TraceConnection(const Trace &t, vlc_tick_t &c)
+                : AbstractConnection(nullptr), trace(t), clock(c) {}
+
+            virtual bool canReuse(const ConnectionParams &) const override
+            {
+                return available;
+            }
+
+            virtual RequestStatus request(const std::string &path,
+                                          const BytesRange & = BytesRange()) override
+            {
+                const size_t pos = path.find("bytes=");
+                if(pos == std::string::npos)
+                    return RequestStatus::NotFound;
+                contentLength = strtoull(path.c_str() + pos + 6, nullptr, 10);
+                bytesRead = 0;
+                return RequestStatus::Success;
+            }
+
+            virtual ssize_t read(void *, size_t len) override
+            {
+                len = std::min(len, contentLength - bytesRead);
+                clock += trace.transferTime(clock, len);
+                bytesRead += len;
+                return len;
+            }
+
+            virtual void setUsed(bool b) override
+            {
+                available = !b;
+            }
+
+        private:
+            const Trace &trace;
+            vlc_tick_t &clock;
+    };
+
+    class TraceConnectionFactory : public AbstractConnectionFactory
+    {
+        public:
+            TraceConnectionFactory(const Trace &t, vlc_tick_t &c)
+                : trace(t), clock(c) {}
+
+            virtual AbstractConnection * createConnection(vlc_object_t *,
+                                                          const ConnectionParams &) override
+            {
+                return new TraceConnection(trace, clock);
+            }
+
+        private:
+            const Trace &trace;
+            vlc_tick_t &clock;
+    };
+
+    struct Results
+    {
+        vlc_tick_t startup = 0;
+        vlc_tick_t stalled = 0;
+        unsigned rebuffers = 0;
+        unsigned switches = 0;
+        uint64_t bitratesum = 0;
+        unsigned segments = 0;
+    };
+
+    class Session
+    {
+        public:
+            Session(const Trace &trace, AbstractAdaptationLogic *logic_)
+                : factory(trace, clock), logic(logic_)
+            {
+                playlist = new BenchPlaylist();
+                BasePeriod *period = new BasePeriod(playlist);
+                set = new BaseAdaptationSet(period);
+                set->setID(ID("video"));
+                period->addAdaptationSet(set);
+                playlist->addPeriod(period);
+                set->addAttribute(new TimescaleAttr(Timescale(CLOCK_FREQ)));
+
+                for(uint64_t bandwidth : LADDER)
+                {
+                    BaseRepresentation *rep = new BaseRepresentation(set);
+                    rep->setBandwidth(bandwidth);
+                    rep->setID(ID(std::to_string(bandwidth)));
+                    SegmentList *list = new SegmentList(rep);
+                    for(unsigned i = 0; i < SEGMENTS_COUNT; i++)
+                    {
+                        Segment *seg = new Segment(rep);
+                        seg->setSequenceNumber(i);
+                        seg->startTime.Set(i * SEGMENT_DURATION);
+                        seg->duration.Set(SEGMENT_DURATION);
+                        list->addSegment(seg);
+                    }
+                    rep->addAttribute(list);
+                    set->addRepresentation(rep);
+                }
+
+                minbuffering = bufferinglogic.getMinBuffering(playlist);
+                maxbuffering = bufferinglogic.getMaxBuffering(playlist);
+                targetbuffering = bufferinglogic.getStableBuffering(playlist);
+            }
+
+            ~Session()
+            {
+                delete playlist;
+            }
+
+            Results run()
+            {
+                Results res;
+                BaseRepresentation *rep = nullptr;
+                vlc_tick_t buffered = 0;
+                bool playing = false;
+                bool started = false;
+
+                logic->trackerEvent(BufferingStateUpdatedEvent(set->getID(), true));
+
+                for(unsigned i = 0; i < SEGMENTS_COUNT; i++)
+                {
+                    /* Wait for room in buffer, as the demuxer would */
+                    if(playing && buffered > maxbuffering - SEGMENT_DURATION)
+                    {
+                        const vlc_tick_t wait = buffered - (maxbuffering - SEGMENT_DURATION);
+                        clock += wait;
+                        buffered -= wait;
+                    }
+
+                    logic->trackerEvent(BufferingLevelChangedEvent(set->getID(), minbuffering,
+                                                                   maxbuffering, buffered,
+                                                                   targetbuffering));
+                    BaseRepresentation *next = logic->getNextRepresentation(set, rep);
+                    if(next != rep)
+                    {
+                        logic->trackerEvent(RepresentationSwitchEvent(rep, next));
+                        if(rep)
+                            res.switches++;
+                        rep = next;
+                    }
+                    logic->trackerEvent(SegmentChangedEvent(set->getID(), i * SEGMENT_DURATION,
+                                                            SEGMENT_DURATION));
+
+                    const vlc_tick_t start = clock;
+                    const size_t size = download(rep, i);
+                    const vlc_tick_t elapsed = clock - start;
+                    logic->updateDownloadRate(set->getID(), size, elapsed, clock);
+
+                    if(playing)
+                    {
+                        if(elapsed > buffered)
+                        {
+                            res.rebuffers++;
+                            res.stalled += elapsed - buffered;
+                            buffered = 0;
+                            playing = false;
+                        }
+                        else buffered -= elapsed;
+                    }
+                    buffered += SEGMENT_DURATION;
+                    res.bitratesum += rep->getBandwidth();
+                    res.segments++;
+
+                    if(!playing && (buffered >= minbuffering || i + 1 == SEGMENTS_COUNT))
+                    {
+                        if(!started)
+                            res.startup = clock;
+                        playing = started = true;
+                    }
+                }
+
+                logic->trackerEvent(BufferingStateUpdatedEvent(set->getID(), false));
+                return res;
+            }
+
+        private:
+            size_t download(const BaseRepresentation *rep, unsigned number)
+            {
+                /* Deterministic +/-20% variation, as from VBR encoding */
+                const size_t nominal = rep->getBandwidth() * SEGMENT_DURATION / CLOCK_FREQ / 8;
+                const size_t size = nominal * (80 + (number * 37) % 41) / 100;
+
+                ConnectionParams params("http://bench/" + rep->getID().str() +
+                                        "/" + std::to_string(number) +
+                                        ".ts?bytes=" + std::to_string(size));
+                std::unique_ptr<AbstractConnection> conn(factory.createConnection(nullptr, params));
+                if(!conn->prepare(params) ||
+                   conn->request(params.getPath()) != RequestStatus::Success)
+                    return 0;
+                conn->setUsed(true);
+
+                size_t total = 0;
+                ssize_t ret;
+                while((ret = conn->read(nullptr, READ_SIZE)) > 0)
+                    total += ret;
+                conn->setUsed(false);
+                return total;
+            }
+
+            vlc_tick_t clock = 0;
+            TraceConnectionFactory factory;
+            AbstractAdaptationLogic *logic;
+            DefaultBufferingLogic bufferinglogic;
+            BenchPlaylist *playlist;
+            BaseAdaptationSet *set;
+            vlc_tick_t minbuffering;
+            vlc_tick_t maxbuffering;
+            vlc_tick_t targetbuffering;
+    };
+
+    std::vector<Trace> builtinTraces()
+    {
+        std::vector<Trace> traces(4);
+
+        traces[0].name = "constant 3Mbps";
+        traces[0].addStep(VLC_TICK_FROM_SEC(60), 3000000);
+
+        traces[1].name = "step down 6M/800k";
+        traces[1].addStep(VLC_TICK_FROM_SEC(120), 6000000);
+        traces[1].addStep(VLC_TICK_FROM_SEC(120), 800000);
+
+        traces[2].name = "oscillating 1M/4M";
+        traces[2].addStep(VLC_TICK_FROM_SEC(10), 1000000);
+        traces[2].addStep(VLC_TICK_FROM_SEC(10), 4000000);
+
+        traces[3].name = "mobile";
+        const unsigned kbps[] = { 2200, 1800, 600, 300, 1500, 4200, 5100, 900, 2600, 3300 };
+        for(unsigned v : kbps)
+            traces[3].addStep(VLC_TICK_FROM_SEC(7), v * 1000);
+
+        return traces;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<Trace> traces;
+    for(int i = 1; i < argc; i++)
+    {
+        Trace trace;
+        if(!trace.load(argv[i]))
+        {
+            fprintf(stderr, "cannot load trace %s\n", argv[i]);
+            return 1;
+        }
+        traces.push_back(trace);
+    }
+    if(traces.empty())
+        traces = builtinTraces();
+
+    const AbstractAdaptationLogic::LogicType logics[] =
+    {
+        AbstractAdaptationLogic::LogicType::RateBased,
+        AbstractAdaptationLogic::LogicType::Predictive,
+        AbstractAdaptationLogic::LogicType::NearOptimal,
+    };
+
+    printf("%-24s %-12s %10s %9s %10s %12s %9s\n", "trace", "logic",
+           "startup ms", "rebuffers", "stalled ms", "avg kbps", "switches");
+
+    for(const Trace &trace : traces)
+    {
+        for(AbstractAdaptationLogic::LogicType type : logics)
+        {
+            std::unique_ptr<AbstractAdaptationLogic> logic;
+            const char *name;
+            switch(type)
+            {
+                case AbstractAdaptationLogic::LogicType::RateBased:
+                    logic.reset(new RateBasedAdaptationLogic(nullptr));
+                    name = "rate";
+                    break;
+                case AbstractAdaptationLogic::LogicType::Predictive:
+                    logic.reset(new PredictiveAdaptationLogic(nullptr));
+                    name = "predictive";
+                    break;
+                case AbstractAdaptationLogic::LogicType::NearOptimal:
+                default:
+                    logic.reset(new NearOptimalAdaptationLogic(nullptr));
+                    name = "nearoptimal";
+                    break;
+            }
+
+            Session session(trace, logic.get());
+            const Results res = session.run();
+
+            printf("%-24s %-12s %10" PRId64 " %9u %10" PRId64 " %12" PRIu64 " %9u\n",
+                   trace.name.c_str(), name, MS_FROM_VLC_TICK(res.startup),
+                   res.rebuffers, MS_FROM_VLC_TICK(res.stalled),
+                   res.segments ? res.bitratesum / res.segments / 1000 : 0,
+                   res.switches);
+        }
+    }
+
+    return 0;
+}
@@ -383,5 +383,103 @@ int M3U8Playlist_test()
     }
 
 
+    return 0;
+}
+
+static bool ExpectSegment(BaseRepresentation *rep, uint64_t number,
+                          vlc_tick_t start, size_t startbyte, size_t endbyte,
+                          const char *keyuri)
+{
+    const Timescale timescale = rep->inheritTimescale();
+    Segment *seg = rep->getMediaSegment(number);
+    return seg && seg->getSequenceNumber() == number &&
+           seg->startTime.Get() == timescale.ToScaled(start) &&
+           seg->getOffset() == startbyte &&
+           seg->contains(endbyte) && !seg->contains(endbyte + 1) &&
+           seg->getEncryption().method == CommonEncryption::Method::AES_128 &&
+           seg->getEncryption().uri == keyuri;
+}
+
+int M3U8PlaylistUpdate_test()
+{
+    vlc_object_t *obj = static_cast<vlc_object_t*>(nullptr);
+
+    const char manifest0[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXT-X-KEY:METHOD=AES-128,URI=\"http://example.com/key1\"\n"
+    "#EXTINF:4,\n"
+    "#EXT-X-BYTERANGE:1000@0\n"
+    "main.ts\n"
+    "#EXTINF:4,\n"
+    "#EXT-X-BYTERANGE:1000\n"
+    "main.ts\n"
+    "#EXTINF:4,\n"
+    "#EXT-X-BYTERANGE:1000\n"
+    "main.ts\n"
+    "#EXTINF:4,\n"
+    "#EXT-X-BYTERANGE:1000\n"
+    "main.ts\n";
+
+    /* Overlaps 12 and 13, continues the implicit byte ranges past the
+     * already known segments, and changes the key for the new ones */
+    const char manifest1[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-MEDIA-SEQUENCE:12\n"
+    "#EXT-X-KEY:METHOD=AES-128,URI=\"http://example.com/key1\"\n"
+    "#EXTINF:4,\n"
+    "#EXT-X-BYTERANGE:1000@2000\n"
+    "main.ts\n"
+    "#EXTINF:4,\n"
+    "#EXT-X-BYTERANGE:1000\n"
+    "main.ts\n"
+    "#EXT-X-KEY:METHOD=AES-128,URI=\"http://example.com/key2\"\n"
+    "#EXTINF:4,\n"
+    "#EXT-X-BYTERANGE:1500\n"
+    "main.ts\n"
+    "#EXTINF:6,\n"
+    "#EXT-X-BYTERANGE:1500\n"
+    "main.ts\n";
+
+    M3U8 *m3u = ParseM3U8(obj, manifest0, sizeof(manifest0));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u->isLive());
+        BaseRepresentation *rep = m3u->getFirstPeriod()->getAdaptationSets().front()->
+                                  getRepresentations().front();
+        Expect(ExpectSegment(rep, 10, vlc_tick_from_sec(0), 0, 999, "http://example.com/key1"));
+        Expect(ExpectSegment(rep, 13, vlc_tick_from_sec(12), 3000, 3999, "http://example.com/key1"));
+
+        M3U8Parser parser(nullptr);
+        stream_t *substream = vlc_stream_MemoryNew(obj, (uint8_t *) manifest1,
+                                                   sizeof(manifest1), true);
+        Expect(substream);
+        parser.appendSegmentsFromStream(static_cast<HLSRepresentation *>(rep), substream);
+        vlc_stream_Delete(substream);
+
+        /* segments before the new media sequence are pruned */
+        Expect(rep->getMediaSegment(11) == nullptr);
+        Expect(ExpectSegment(rep, 12, vlc_tick_from_sec(8), 2000, 2999, "http://example.com/key1"));
+        Expect(ExpectSegment(rep, 13, vlc_tick_from_sec(12), 3000, 3999, "http://example.com/key1"));
+        Expect(ExpectSegment(rep, 14, vlc_tick_from_sec(16), 4000, 5499, "http://example.com/key2"));
+        Expect(ExpectSegment(rep, 15, vlc_tick_from_sec(20), 5500, 6999, "http://example.com/key2"));
+        Expect(rep->getMediaSegment(16) == nullptr);
+
+        vlc_tick_t begin, end, duration;
+        Expect(rep->getMediaPlaybackRange(&begin, &end, &duration));
+        Expect(begin == vlc_tick_from_sec(8));
+        Expect(end == vlc_tick_from_sec(26));
+
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
+
     return 0;
 }
@@ -47,5 +47,6 @@ int main()
     TEST(BufferingLogic) ||
     TEST(CommandsQueue) ||
     TEST(M3U8MasterPlaylist) ||
-    TEST(M3U8Playlist);
+    TEST(M3U8Playlist) ||
+    TEST(M3U8PlaylistUpdate);
 }
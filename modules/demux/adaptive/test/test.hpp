@@ -45,6 +45,7 @@ int Timeline_test();
 int Conversions_test();
 int M3U8MasterPlaylist_test();
 int M3U8Playlist_test();
+int M3U8PlaylistUpdate_test();
 int CommandsQueue_test();
 int BufferingLogic_test();
 
@@ -160,27 +160,6 @@ void M3U8Parser::createAndFillRepresentation(vlc_object_t *p_obj, BaseAdaptation
     }
 }
 
-bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
-{
-    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
-    if(p_block)
-    {
-        stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
-        if(substream)
-        {
-            std::list<Tag *> tagslist = parseEntries(substream);
-            vlc_stream_Delete(substream);
-
-            parseSegments(p_obj, rep, tagslist);
-
-            releaseTagsList(tagslist);
-        }
-        block_Release(p_block);
-        return true;
-    }
-    return false;
-}
-
 static bool parseEncryption(const AttributesTag *keytag, const Url &playlistUrl,
                             CommonEncryption &encryption)
 {
@@ -216,172 +195,241 @@ static bool parseEncryption(const AttributesTag *keytag, const Url &playlistUrl,
     }
 }
 
-void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std::list<Tag *> &tagslist)
+class M3U8Parser::SegmentsBuilder
+{
+    public:
+        SegmentsBuilder(HLSRepresentation *);
+        ~SegmentsBuilder();
+        void process(const Tag *);
+        void finish();
+
+    private:
+        HLSRepresentation *rep;
+        SegmentList *segmentList;
+        Timescale timescale;
+        vlc_tick_t totalduration;
+        vlc_tick_t nzStartTime;
+        vlc_tick_t absReferenceTime;
+        uint64_t sequenceNumber;
+        uint64_t lastKnownNumber;
+        bool hasKnownSegments;
+        bool hasFirstSegment;
+        bool discontinuity;
+        std::size_t prevbyterangeoffset;
+        const SingleValueTag *ctx_byterange;
+        CommonEncryption encryption;
+        const ValuesListTag *ctx_extinf;
+        std::list<HLSSegment *> segmentstoappend;
+};
+
+M3U8Parser::SegmentsBuilder::SegmentsBuilder(HLSRepresentation *rep_)
+    : timescale(1000000)
 {
-    SegmentList *segmentList = new (std::nothrow) SegmentList(rep);
+    rep = rep_;
+    segmentList = new (std::nothrow) SegmentList(rep);
+    totalduration = 0;
+    nzStartTime = 0;
+    absReferenceTime = VLC_TICK_INVALID;
+    sequenceNumber = 0;
+    lastKnownNumber = 0;
+    hasFirstSegment = false;
+    discontinuity = false;
+    prevbyterangeoffset = 0;
+    ctx_byterange = nullptr;
+    ctx_extinf = nullptr;
+
+    /* On refresh, segments we already have will be dropped by the merge:
+     * no need to build them again */
+    const SegmentList *current = rep->b_loaded
+            ? static_cast<SegmentList *>(rep->getAttribute(AbstractAttr::Type::SegmentList))
+            : nullptr;
+    hasKnownSegments = current && !current->getSegments().empty();
+    if(hasKnownSegments)
+        lastKnownNumber = current->getSegments().back()->getSequenceNumber();
 
-    Timescale timescale(1000000);
     rep->addAttribute(new TimescaleAttr(timescale));
     rep->b_loaded = true;
+}
 
-    vlc_tick_t totalduration = 0;
-    vlc_tick_t nzStartTime = 0;
-    vlc_tick_t absReferenceTime = VLC_TICK_INVALID;
-    uint64_t sequenceNumber = 0;
-    bool discontinuity = false;
-    std::size_t prevbyterangeoffset = 0;
-    const SingleValueTag *ctx_byterange = nullptr;
-    CommonEncryption encryption;
-    const ValuesListTag *ctx_extinf = nullptr;
+M3U8Parser::SegmentsBuilder::~SegmentsBuilder()
+{
+    for(HLSSegment *seg : segmentstoappend)
+        delete seg;
+    delete segmentList;
+}
 
-    std::list<HLSSegment *> segmentstoappend;
+void M3U8Parser::SegmentsBuilder::process(const Tag *tag)
+{
+    if(!segmentList)
+        return;
 
-    std::list<Tag *>::const_iterator it;
-    for(it = tagslist.begin(); it != tagslist.end(); ++it)
+    switch(tag->getType())
     {
-        const Tag *tag = *it;
-        switch(tag->getType())
+        /* using static cast as attribute type permits avoiding class check */
+        case SingleValueTag::EXTXMEDIASEQUENCE:
         {
-            /* using static cast as attribute type permits avoiding class check */
-            case SingleValueTag::EXTXMEDIASEQUENCE:
+            sequenceNumber = (static_cast<const SingleValueTag*>(tag))->getValue().decimal();
+        }
+        break;
+
+        case ValuesListTag::EXTINF:
+        {
+            ctx_extinf = static_cast<const ValuesListTag *>(tag);
+        }
+        break;
+
+        case SingleValueTag::URI:
+        {
+            const SingleValueTag *uritag = static_cast<const SingleValueTag *>(tag);
+            if(uritag->getValue().value.empty())
             {
-                sequenceNumber = (static_cast<const SingleValueTag*>(tag))->getValue().decimal();
+                ctx_extinf = nullptr;
+                ctx_byterange = nullptr;
+                break;
             }
-            break;
 
-            case ValuesListTag::EXTINF:
+            /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
+            vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
+            if(ctx_extinf)
             {
-                ctx_extinf = static_cast<const ValuesListTag *>(tag);
+                const Attribute *durAttribute = ctx_extinf->getAttributeByName("DURATION");
+                if(durAttribute)
+                    nzDuration = vlc_tick_from_sec(durAttribute->floatingPoint());
+                ctx_extinf = nullptr;
             }
-            break;
 
-            case SingleValueTag::URI:
+            std::pair<std::size_t,std::size_t> range(0, 0);
+            if(ctx_byterange)
             {
-                const SingleValueTag *uritag = static_cast<const SingleValueTag *>(tag);
-                if(uritag->getValue().value.empty())
-                {
-                    ctx_extinf = nullptr;
-                    ctx_byterange = nullptr;
-                    break;
-                }
-
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
-                if(!segment)
-                    break;
-
-                segment->setSourceUrl(uritag->getValue().value);
+                range = ctx_byterange->getValue().getByteRange();
+                if(range.first == 0) /* first == size, second = offset */
+                    range.first = prevbyterangeoffset;
+                prevbyterangeoffset = range.first + range.second;
+            }
 
-                /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
-                vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
-                if(ctx_extinf)
-                {
-                    const Attribute *durAttribute = ctx_extinf->getAttributeByName("DURATION");
-                    if(durAttribute)
-                        nzDuration = vlc_tick_from_sec(durAttribute->floatingPoint());
-                    ctx_extinf = nullptr;
-                }
-                segment->duration.Set(timescale.ToScaled(nzDuration));
-                segment->startTime.Set(timescale.ToScaled(nzStartTime));
+            /* The first one is always kept as it sets the pruning point of the merge */
+            if(hasFirstSegment && hasKnownSegments && sequenceNumber <= lastKnownNumber)
+            {
+                sequenceNumber++;
                 nzStartTime += nzDuration;
                 totalduration += nzDuration;
                 if(absReferenceTime != VLC_TICK_INVALID)
-                {
-                    segment->setDisplayTime(absReferenceTime);
                     absReferenceTime += nzDuration;
-                }
+                ctx_byterange = nullptr;
+                discontinuity = false;
+                break;
+            }
 
-                segmentstoappend.push_back(segment);
+            HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
+            if(!segment)
+                break;
+            hasFirstSegment = true;
 
-                if(ctx_byterange)
-                {
-                    std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
-                    if(range.first == 0) /* first == size, second = offset */
-                        range.first = prevbyterangeoffset;
-                    prevbyterangeoffset = range.first + range.second;
-                    segment->setByteRange(range.first, prevbyterangeoffset - 1);
-                    ctx_byterange = nullptr;
-                }
+            segment->setSourceUrl(uritag->getValue().value);
 
-                if(discontinuity)
-                {
-                    segment->discontinuity = true;
-                    discontinuity = false;
-                }
+            segment->duration.Set(timescale.ToScaled(nzDuration));
+            segment->startTime.Set(timescale.ToScaled(nzStartTime));
+            nzStartTime += nzDuration;
+            totalduration += nzDuration;
+            if(absReferenceTime != VLC_TICK_INVALID)
+            {
+                segment->setDisplayTime(absReferenceTime);
+                absReferenceTime += nzDuration;
+            }
 
-                if(encryption.method != CommonEncryption::Method::None)
-                    segment->setEncryption(encryption);
+            segmentstoappend.push_back(segment);
+
+            if(ctx_byterange)
+            {
+                segment->setByteRange(range.first, prevbyterangeoffset - 1);
+                ctx_byterange = nullptr;
             }
-            break;
 
-            case SingleValueTag::EXTXTARGETDURATION:
-                rep->targetDuration = static_cast<const SingleValueTag *>(tag)->getValue().decimal();
-                break;
+            if(discontinuity)
+            {
+                segment->discontinuity = true;
+                discontinuity = false;
+            }
 
-            case SingleValueTag::EXTXPLAYLISTTYPE:
-                rep->b_live = (static_cast<const SingleValueTag *>(tag)->getValue().value != "VOD");
-                break;
+            if(encryption.method != CommonEncryption::Method::None)
+                segment->setEncryption(encryption);
+        }
+        break;
 
-            case SingleValueTag::EXTXBYTERANGE:
-                ctx_byterange = static_cast<const SingleValueTag *>(tag);
-                break;
+        case SingleValueTag::EXTXTARGETDURATION:
+            rep->targetDuration = static_cast<const SingleValueTag *>(tag)->getValue().decimal();
+            break;
+
+        case SingleValueTag::EXTXPLAYLISTTYPE:
+            rep->b_live = (static_cast<const SingleValueTag *>(tag)->getValue().value != "VOD");
+            break;
+
+        case SingleValueTag::EXTXBYTERANGE:
+            ctx_byterange = static_cast<const SingleValueTag *>(tag);
+            break;
 
-            case SingleValueTag::EXTXPROGRAMDATETIME:
-                rep->b_consistent = false;
-                absReferenceTime = VLC_TICK_0 +
-                        UTCTime(static_cast<const SingleValueTag *>(tag)->getValue().value).mtime();
-                /* Reverse apply UTC timespec from first discont */
-                if(segmentstoappend.size() && segmentstoappend.back()->getDisplayTime() == VLC_TICK_INVALID)
+        case SingleValueTag::EXTXPROGRAMDATETIME:
+            rep->b_consistent = false;
+            absReferenceTime = VLC_TICK_0 +
+                    UTCTime(static_cast<const SingleValueTag *>(tag)->getValue().value).mtime();
+            /* Reverse apply UTC timespec from first discont */
+            if(segmentstoappend.size() && segmentstoappend.back()->getDisplayTime() == VLC_TICK_INVALID)
+            {
+                vlc_tick_t tempTime = absReferenceTime;
+                for(auto it = segmentstoappend.crbegin(); it != segmentstoappend.crend(); ++it)
                 {
-                    vlc_tick_t tempTime = absReferenceTime;
-                    for(auto it = segmentstoappend.crbegin(); it != segmentstoappend.crend(); ++it)
-                    {
-                        vlc_tick_t duration = timescale.ToTime((*it)->duration.Get());
-                        if( duration < tempTime - VLC_TICK_0 )
-                            tempTime -= duration;
-                        else
-                            tempTime = VLC_TICK_0;
-                        (*it)->setDisplayTime(tempTime);
-                    }
+                    vlc_tick_t duration = timescale.ToTime((*it)->duration.Get());
+                    if( duration < tempTime - VLC_TICK_0 )
+                        tempTime -= duration;
+                    else
+                        tempTime = VLC_TICK_0;
+                    (*it)->setDisplayTime(tempTime);
                 }
-                break;
-
-            case AttributesTag::EXTXKEY:
-                parseEncryption(static_cast<const AttributesTag *>(tag),
-                                rep->getPlaylistUrl(), encryption);
+            }
             break;
 
-            case AttributesTag::EXTXMAP:
+        case AttributesTag::EXTXKEY:
+            parseEncryption(static_cast<const AttributesTag *>(tag),
+                            rep->getPlaylistUrl(), encryption);
+        break;
+
+        case AttributesTag::EXTXMAP:
+        {
+            const AttributesTag *keytag = static_cast<const AttributesTag *>(tag);
+            const Attribute *uriAttr;
+            if(keytag && (uriAttr = keytag->getAttributeByName("URI")) &&
+               !segmentList->initialisationSegment.Get()) /* FIXME: handle discontinuities */
             {
-                const AttributesTag *keytag = static_cast<const AttributesTag *>(tag);
-                const Attribute *uriAttr;
-                if(keytag && (uriAttr = keytag->getAttributeByName("URI")) &&
-                   !segmentList->initialisationSegment.Get()) /* FIXME: handle discontinuities */
+                InitSegment *initSegment = new (std::nothrow) InitSegment(rep);
+                if(initSegment)
                 {
-                    InitSegment *initSegment = new (std::nothrow) InitSegment(rep);
-                    if(initSegment)
+                    initSegment->setSourceUrl(uriAttr->quotedString());
+                    const Attribute *byterangeAttr = keytag->getAttributeByName("BYTERANGE");
+                    if(byterangeAttr)
                     {
-                        initSegment->setSourceUrl(uriAttr->quotedString());
-                        const Attribute *byterangeAttr = keytag->getAttributeByName("BYTERANGE");
-                        if(byterangeAttr)
-                        {
-                            const std::pair<std::size_t,std::size_t> range = byterangeAttr->unescapeQuotes().getByteRange();
-                            initSegment->setByteRange(range.first, range.first + range.second - 1);
-                        }
-                        segmentList->initialisationSegment.Set(initSegment);
+                        const std::pair<std::size_t,std::size_t> range = byterangeAttr->unescapeQuotes().getByteRange();
+                        initSegment->setByteRange(range.first, range.first + range.second - 1);
                     }
+                    segmentList->initialisationSegment.Set(initSegment);
                 }
             }
-            break;
+        }
+        break;
 
-            case Tag::EXTXDISCONTINUITY:
-                discontinuity  = true;
-                break;
+        case Tag::EXTXDISCONTINUITY:
+            discontinuity  = true;
+            break;
 
-            case Tag::EXTXENDLIST:
-                rep->b_live = false;
-                break;
-        }
+        case Tag::EXTXENDLIST:
+            rep->b_live = false;
+            break;
     }
+}
+
+void M3U8Parser::SegmentsBuilder::finish()
+{
+    if(!segmentList)
+        return;
 
     for(HLSSegment *seg : segmentstoappend)
         segmentList->addSegment(seg);
@@ -397,7 +445,48 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     }
 
     rep->updateSegmentList(segmentList, true);
+    segmentList = nullptr;
+}
+
+void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std::list<Tag *> &tagslist)
+{
+    SegmentsBuilder builder(rep);
+    for(const Tag *tag : tagslist)
+        builder.process(tag);
+    builder.finish();
+}
+
+bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
+{
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
+    if(p_block)
+    {
+        stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
+        if(substream)
+        {
+            appendSegmentsFromStream(rep, substream);
+            vlc_stream_Delete(substream);
+        }
+        block_Release(p_block);
+        return true;
+    }
+    return false;
+}
+
+void M3U8Parser::appendSegmentsFromStream(HLSRepresentation *rep, stream_t *substream)
+{
+    /* Consume tags as they are read, so we never hold the whole
+     * playlist representation in memory */
+    SegmentsBuilder builder(rep);
+    parseEntries(substream, [&builder](std::list<Tag *> &tagslist)
+    {
+        for(const Tag *tag : tagslist)
+            builder.process(tag);
+        releaseTagsList(tagslist);
+    });
+    builder.finish();
 }
+
 M3U8 * M3U8Parser::parse(vlc_object_t *p_object, stream_t *p_stream, const std::string &playlisturl)
 {
     char *psz_line = vlc_stream_ReadLine(p_stream);
@@ -620,6 +709,16 @@ M3U8 * M3U8Parser::parse(vlc_object_t *p_object, stream_t *p_stream, const std::
 }
 
 std::list<Tag *> M3U8Parser::parseEntries(stream_t *stream)
+{
+    std::list<Tag *> entrieslist;
+    parseEntries(stream, [&entrieslist](std::list<Tag *> &tags)
+    {
+        entrieslist.splice(entrieslist.end(), tags);
+    });
+    return entrieslist;
+}
+
+void M3U8Parser::parseEntries(stream_t *stream, const EntriesHandler &handler)
 {
     std::list<Tag *> entrieslist;
     Tag *lastTag = nullptr;
@@ -669,6 +768,8 @@ std::list<Tag *> M3U8Parser::parseEntries(stream_t *stream)
                 Tag *tag = TagFactory::createTagByName("", std::string(psz_line));
                 if(tag)
                     entrieslist.push_back(tag);
+                /* segment entry complete, no more references to previous tags */
+                handler(entrieslist);
             }
             lastTag = nullptr;
         }
@@ -680,5 +781,6 @@ std::list<Tag *> M3U8Parser::parseEntries(stream_t *stream)
         free(psz_line);
     }
 
-    return entrieslist;
+    if(!entrieslist.empty())
+        handler(entrieslist);
 }
@@ -23,6 +23,7 @@
 #include "../../adaptive/playlist/SegmentBaseType.hpp"
 
 #include <cstdlib>
+#include <functional>
 #include <sstream>
 #include <list>
 
@@ -60,13 +61,17 @@ namespace hls
 
                 M3U8 *             parse  (vlc_object_t *p_obj, stream_t *p_stream, const std::string &);
                 bool appendSegmentsFromPlaylistURI(vlc_object_t *, HLSRepresentation *);
+                void appendSegmentsFromStream(HLSRepresentation *, stream_t *);
 
             private:
                 HLSRepresentation * createRepresentation(BaseAdaptationSet *, const AttributesTag *);
                 void createAndFillRepresentation(vlc_object_t *, BaseAdaptationSet *,
                                                  const AttributesTag *, const std::list<Tag *>&);
+                class SegmentsBuilder;
+                using EntriesHandler = std::function<void(std::list<Tag *> &)>;
                 void parseSegments(vlc_object_t *, HLSRepresentation *, const std::list<Tag *>&);
                 std::list<Tag *> parseEntries(stream_t *);
+                void parseEntries(stream_t *, const EntriesHandler &);
                 adaptive::SharedResources *resources;
         };
     }
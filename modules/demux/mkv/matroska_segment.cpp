@@ -28,10 +28,14 @@
 #include "Ebml_parser.hpp"
 #include "Ebml_dispatcher.hpp"
 
+#include <vlc_fs.h>
+
 #include <new>
 #include <iterator>
 #include <limits>
 
+#include <sys/stat.h>
+
 namespace mkv {
 
 matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estream, KaxSegment *p_seg )
@@ -63,6 +67,9 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,ep( EbmlParser(&estream, p_seg, &demuxer.demuxer ))
     ,b_preloaded(false)
     ,b_ref_external_segments(false)
+    ,i_seek_index_file_size(0)
+    ,i_seek_index_file_mtime(0)
+    ,i_seek_index_size(0)
 {
 }
 
@@ -518,6 +525,225 @@ bool matroska_segment_c::PreloadClusters(uint64 i_cluster_pos)
     return true;
 }
 
+void matroska_segment_c::ReadAheadCluster()
+{
+    /* small clusters are fetched together with the following ones */
+    static const uint64 i_readahead_min = 1024 * 1024;
+
+    if( sys.b_fastseekable || cluster == NULL )
+        return;
+
+    vlc_stream_io_callback *io_callback = dynamic_cast<vlc_stream_io_callback *>( &es.I_O() );
+    if( io_callback == NULL )
+        return;
+
+    uint64 i_pos = es.I_O().getFilePointer();
+    uint64 i_end = cluster->IsFiniteSize() ? cluster->GetEndPosition() : i_pos;
+
+    /* the Cues tell where the next clusters start */
+    SegmentSeeker::cluster_positions_t const& positions = _seeker._cluster_positions;
+    SegmentSeeker::cluster_positions_t::const_iterator it =
+        std::upper_bound( positions.begin(), positions.end(), i_end );
+
+    if( i_end <= i_pos )
+    {
+        /* unknown size, it ends where the next cluster starts */
+        if( it == positions.end() )
+            return;
+        i_end = *it++;
+    }
+
+    while( i_end - i_pos < i_readahead_min && it != positions.end() &&
+           *it - i_pos <= vlc_stream_io_callback::READAHEAD_MAX )
+        i_end = *it++;
+
+    io_callback->ReadAhead( i_end - i_pos );
+}
+
+/*****************************************************************************
+ * Seek index cache: the seekpoints found by scanning a file without Cues
+ * are kept in the user cache directory, keyed by the segment UID and
+ * checked against the file size and modification time
+ *****************************************************************************/
+static const char seek_index_magic[8] = { 'V', 'L', 'C', 'M', 'K', 'V', 'S', 'I' };
+static const uint32_t seek_index_version = 1;
+static const uint64_t seek_index_cache_max = 16 * 1024 * 1024;
+static const time_t   seek_index_tmp_max_age = 24 * 3600;
+
+/* Removes the oldest indexes once the cache directory is over its size
+ * limit, as well as temporary files left behind by interrupted writers */
+static void PruneSeekIndexCache( const std::string & dir, const std::string & keep )
+{
+    struct cached_index
+    {
+        std::string path;
+        time_t      mtime;
+        uint64_t    size;
+    };
+    std::vector<cached_index> indexes;
+    uint64_t i_total = 0;
+    const time_t now = time( NULL );
+
+    DIR *p_dir = vlc_opendir( dir.c_str() );
+    if( p_dir == NULL )
+        return;
+
+    const char *psz_name;
+    while( ( psz_name = vlc_readdir( p_dir ) ) != NULL )
+    {
+        std::string name( psz_name );
+        std::string path = dir + DIR_SEP + name;
+        struct stat st;
+
+        size_t i_ext = name.rfind( ".idx" );
+        if( i_ext == std::string::npos ||
+            vlc_stat( path.c_str(), &st ) != 0 || !S_ISREG( st.st_mode ) )
+            continue;
+
+        if( i_ext + 4 != name.size() )
+        {
+            if( now - st.st_mtime > seek_index_tmp_max_age )
+                vlc_unlink( path.c_str() );
+            continue;
+        }
+
+        i_total += st.st_size;
+        if( path != keep )
+            indexes.push_back( { path, st.st_mtime, (uint64_t) st.st_size } );
+    }
+    closedir( p_dir );
+
+    if( i_total <= seek_index_cache_max )
+        return;
+
+    std::sort( indexes.begin(), indexes.end(),
+               []( const cached_index & a, const cached_index & b ) {
+                   return a.mtime < b.mtime;
+               } );
+    for( size_t i = 0; i < indexes.size() && i_total > seek_index_cache_max; i++ )
+    {
+        if( vlc_unlink( indexes[i].path.c_str() ) == 0 )
+            i_total -= indexes[i].size;
+    }
+}
+
+void matroska_segment_c::LoadSeekIndex()
+{
+    const char *psz_path = sys.demuxer.psz_filepath;
+    struct stat st;
+
+    if( b_cues || p_segment_uid == NULL || p_segment_uid->GetSize() == 0 ||
+        psz_path == NULL || !var_InheritBool( &sys.demuxer, "mkv-seek-index-cache" ) ||
+        vlc_stat( psz_path, &st ) != 0 )
+        return;
+
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( psz_cachedir == NULL )
+        return;
+
+    std::string name;
+    for( size_t i = 0; i < p_segment_uid->GetSize(); i++ )
+    {
+        char hex[3];
+        snprintf( hex, sizeof( hex ), "%02x", p_segment_uid->GetBuffer()[i] );
+        name += hex;
+    }
+    seek_index_path = std::string( psz_cachedir ) + DIR_SEP "mkv" DIR_SEP + name + ".idx";
+    free( psz_cachedir );
+
+    i_seek_index_file_size = st.st_size;
+    i_seek_index_file_mtime = st.st_mtime;
+    i_seek_index_size = _seeker.index_size();
+
+    FILE *f = vlc_fopen( seek_index_path.c_str(), "rb" );
+    if( f == NULL )
+        return;
+
+    char magic[sizeof( seek_index_magic )];
+    uint32_t i_version, i_uid_size;
+    uint64_t i_file_size;
+    int64_t i_file_mtime;
+    uint8_t uid[128];
+
+    if( fread( magic, sizeof( magic ), 1, f ) == 1 &&
+        !memcmp( magic, seek_index_magic, sizeof( magic ) ) &&
+        fread( &i_version, sizeof( i_version ), 1, f ) == 1 && i_version == seek_index_version &&
+        fread( &i_file_size, sizeof( i_file_size ), 1, f ) == 1 && i_file_size == i_seek_index_file_size &&
+        fread( &i_file_mtime, sizeof( i_file_mtime ), 1, f ) == 1 && i_file_mtime == i_seek_index_file_mtime &&
+        fread( &i_uid_size, sizeof( i_uid_size ), 1, f ) == 1 && i_uid_size == p_segment_uid->GetSize() &&
+        i_uid_size <= sizeof( uid ) && fread( uid, i_uid_size, 1, f ) == 1 &&
+        !memcmp( uid, p_segment_uid->GetBuffer(), i_uid_size ) )
+    {
+        SegmentSeeker loaded;
+
+        if( loaded.load( f ) )
+        {
+            _seeker.merge( loaded );
+            i_seek_index_size = _seeker.index_size();
+            msg_Dbg( &sys.demuxer, "loaded seek index from %s", seek_index_path.c_str() );
+        }
+        else
+        {
+            fclose( f );
+            msg_Warn( &sys.demuxer, "discarding truncated seek index %s", seek_index_path.c_str() );
+            vlc_unlink( seek_index_path.c_str() );
+            return;
+        }
+    }
+    fclose( f );
+}
+
+void matroska_segment_c::StoreSeekIndex()
+{
+    if( seek_index_path.empty() || _seeker.index_size() <= i_seek_index_size )
+        return;
+
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( psz_cachedir == NULL )
+        return;
+    std::string dir = std::string( psz_cachedir ) + DIR_SEP "mkv";
+    vlc_mkdir( psz_cachedir, 0700 );
+    vlc_mkdir( dir.c_str(), 0700 );
+    free( psz_cachedir );
+
+    /* each writer gets its own temporary file, the rename is atomic */
+    std::string tmpl = seek_index_path + ".XXXXXX";
+    std::vector<char> tmp_path( tmpl.begin(), tmpl.end() );
+    tmp_path.push_back( '\0' );
+    int fd = vlc_mkstemp( tmp_path.data() );
+    if( fd == -1 )
+    {
+        msg_Dbg( &sys.demuxer, "cannot write seek index %s", seek_index_path.c_str() );
+        return;
+    }
+    FILE *f = fdopen( fd, "wb" );
+    if( f == NULL )
+    {
+        vlc_close( fd );
+        vlc_unlink( tmp_path.data() );
+        return;
+    }
+
+    uint32_t i_uid_size = p_segment_uid->GetSize();
+    bool ok = fwrite( seek_index_magic, sizeof( seek_index_magic ), 1, f ) == 1 &&
+              fwrite( &seek_index_version, sizeof( seek_index_version ), 1, f ) == 1 &&
+              fwrite( &i_seek_index_file_size, sizeof( i_seek_index_file_size ), 1, f ) == 1 &&
+              fwrite( &i_seek_index_file_mtime, sizeof( i_seek_index_file_mtime ), 1, f ) == 1 &&
+              fwrite( &i_uid_size, sizeof( i_uid_size ), 1, f ) == 1 &&
+              fwrite( p_segment_uid->GetBuffer(), i_uid_size, 1, f ) == 1 &&
+              _seeker.save( f );
+
+    if( fclose( f ) != 0 || !ok || vlc_rename( tmp_path.data(), seek_index_path.c_str() ) != 0 )
+    {
+        msg_Dbg( &sys.demuxer, "cannot write seek index %s", seek_index_path.c_str() );
+        vlc_unlink( tmp_path.data() );
+        return;
+    }
+    i_seek_index_size = _seeker.index_size();
+
+    PruneSeekIndexCache( dir, seek_index_path );
+}
+
 bool matroska_segment_c::PreloadFamily( const matroska_segment_c & of_segment )
 {
     if ( b_preloaded )
@@ -1212,6 +1438,7 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
         {
             vars.obj->cluster = &kcluster;
             vars.b_cluster_timecode = false;
+            vars.obj->ReadAheadCluster();
             vars.ep->Down ();
         }
         E_CASE( KaxCues, kcue )
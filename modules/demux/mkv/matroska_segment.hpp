@@ -146,6 +146,9 @@ public:
 
     bool Seek( demux_t &, vlc_tick_t i_mk_date, vlc_tick_t i_mk_time_offset, bool b_accurate );
 
+    void LoadSeekIndex();
+    void StoreSeekIndex();
+
     int BlockGet( KaxBlock * &, KaxSimpleBlock * &, KaxBlockAdditions * &,
                   bool *, bool *, int64_t *);
 
@@ -174,9 +177,16 @@ private:
     bool TrackInit( mkv_track_t * p_tk );
     void ComputeTrackPriority();
     void EnsureDuration();
+    void ReadAheadCluster();
 
     SegmentSeeker _seeker;
 
+    /* seek index cache, the path is empty when it is not used */
+    std::string             seek_index_path;
+    uint64_t                i_seek_index_file_size;
+    int64_t                 i_seek_index_file_mtime;
+    size_t                  i_seek_index_size;
+
     friend SegmentSeeker;
 };
 
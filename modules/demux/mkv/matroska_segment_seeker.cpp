@@ -46,6 +46,16 @@ namespace {
 
     template<class It> It prev_( It it ) { return --it; }
     template<class It> It next_( It it ) { return ++it; }
+
+    template<class T> bool write_( FILE *f, T value )
+    {
+        return fwrite( &value, sizeof( value ), 1, f ) == 1;
+    }
+
+    template<class T> bool read_( FILE *f, T& value )
+    {
+        return fread( &value, sizeof( value ), 1, f ) == 1;
+    }
 }
 
 namespace mkv {
@@ -461,6 +471,128 @@ SegmentSeeker::get_search_areas( fptr_t start, fptr_t end ) const
     return areas_to_search;
 }
 
+size_t
+SegmentSeeker::index_size() const
+{
+    size_t count = _ranges_searched.size() + _cluster_positions.size() + _clusters.size();
+
+    for( tracks_seekpoints_t::const_iterator it = _tracks_seekpoints.begin(); it != _tracks_seekpoints.end(); ++it )
+        count += it->second.size();
+
+    return count;
+}
+
+bool
+SegmentSeeker::save( FILE *f ) const
+{
+    bool ok = write_<uint32_t>( f, _ranges_searched.size() );
+    for( ranges_t::const_iterator it = _ranges_searched.begin(); ok && it != _ranges_searched.end(); ++it )
+        ok = write_<uint64_t>( f, it->start ) && write_<uint64_t>( f, it->end );
+
+    ok = ok && write_<uint32_t>( f, _cluster_positions.size() );
+    for( cluster_positions_t::const_iterator it = _cluster_positions.begin(); ok && it != _cluster_positions.end(); ++it )
+        ok = write_<uint64_t>( f, *it );
+
+    ok = ok && write_<uint32_t>( f, _clusters.size() );
+    for( cluster_map_t::const_iterator it = _clusters.begin(); ok && it != _clusters.end(); ++it )
+        ok = write_<uint64_t>( f, it->second.fpos ) && write_<int64_t>( f, it->second.pts ) &&
+             write_<int64_t>( f, it->second.duration ) && write_<uint64_t>( f, it->second.size );
+
+    ok = ok && write_<uint32_t>( f, _tracks_seekpoints.size() );
+    for( tracks_seekpoints_t::const_iterator it = _tracks_seekpoints.begin(); ok && it != _tracks_seekpoints.end(); ++it )
+    {
+        ok = write_<uint32_t>( f, it->first ) && write_<uint32_t>( f, it->second.size() );
+        for( seekpoints_t::const_iterator sp = it->second.begin(); ok && sp != it->second.end(); ++sp )
+            ok = write_<uint64_t>( f, sp->fpos ) && write_<int64_t>( f, sp->pts ) &&
+                 write_<int32_t>( f, sp->trust_level );
+    }
+
+    return ok;
+}
+
+bool
+SegmentSeeker::load( FILE *f )
+{
+    uint32_t count;
+
+    if( !read_( f, count ) )
+        return false;
+    while( count-- )
+    {
+        uint64_t start, end;
+        if( !read_( f, start ) || !read_( f, end ) || start > end )
+            return false;
+        mark_range_as_searched( Range( start, end ) );
+    }
+
+    if( !read_( f, count ) )
+        return false;
+    while( count-- )
+    {
+        uint64_t fpos;
+        if( !read_( f, fpos ) )
+            return false;
+        cluster_positions_t::iterator it = std::lower_bound( _cluster_positions.begin(), _cluster_positions.end(), fpos );
+        if( it == _cluster_positions.end() || *it != fpos )
+            _cluster_positions.insert( it, fpos );
+    }
+
+    if( !read_( f, count ) )
+        return false;
+    while( count-- )
+    {
+        uint64_t fpos, size;
+        int64_t pts, duration;
+        if( !read_( f, fpos ) || !read_( f, pts ) || !read_( f, duration ) || !read_( f, size ) )
+            return false;
+        Cluster cinfo = { fpos, pts, duration, size };
+        _clusters.insert( cluster_map_t::value_type( pts, cinfo ) );
+    }
+
+    if( !read_( f, count ) )
+        return false;
+    while( count-- )
+    {
+        uint32_t track_id, points;
+        if( !read_( f, track_id ) || !read_( f, points ) )
+            return false;
+        while( points-- )
+        {
+            uint64_t fpos;
+            int64_t pts;
+            int32_t trust_level;
+            if( !read_( f, fpos ) || !read_( f, pts ) || !read_( f, trust_level ) )
+                return false;
+            if( trust_level != Seekpoint::TRUSTED && trust_level != Seekpoint::QUESTIONABLE &&
+                trust_level != Seekpoint::DISABLED )
+                return false;
+            add_seekpoint( track_id, Seekpoint( fpos, pts, Seekpoint::TrustLevel( trust_level ) ) );
+        }
+    }
+
+    return true;
+}
+
+void
+SegmentSeeker::merge( SegmentSeeker const& other )
+{
+    for( ranges_t::const_iterator it = other._ranges_searched.begin(); it != other._ranges_searched.end(); ++it )
+        mark_range_as_searched( *it );
+
+    for( cluster_positions_t::const_iterator it = other._cluster_positions.begin(); it != other._cluster_positions.end(); ++it )
+    {
+        cluster_positions_t::iterator pos = std::lower_bound( _cluster_positions.begin(), _cluster_positions.end(), *it );
+        if( pos == _cluster_positions.end() || *pos != *it )
+            _cluster_positions.insert( pos, *it );
+    }
+
+    _clusters.insert( other._clusters.begin(), other._clusters.end() );
+
+    for( tracks_seekpoints_t::const_iterator it = other._tracks_seekpoints.begin(); it != other._tracks_seekpoints.end(); ++it )
+        for( seekpoints_t::const_iterator sp = it->second.begin(); sp != it->second.end(); ++sp )
+            add_seekpoint( it->first, *sp );
+}
+
 void
 SegmentSeeker::mkv_jump_to( matroska_segment_c& ms, fptr_t fpos )
 {
@@ -528,6 +660,8 @@ SegmentSeeker::mkv_jump_to( matroska_segment_c& ms, fptr_t fpos )
 
     if ( fpos != std::numeric_limits<SegmentSeeker::fptr_t>::max() )
         ms.es.I_O().setFilePointer( fpos );
+
+    ms.ReadAheadCluster();
 }
 
 } // namespace
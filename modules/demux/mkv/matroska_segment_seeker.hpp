@@ -26,6 +26,7 @@
 #include "mkv.hpp"
 
 #include <algorithm>
+#include <cstdio>
 #include <vector>
 #include <map>
 #include <limits>
@@ -119,6 +120,13 @@ class SegmentSeeker
         void mark_range_as_searched( Range );
         ranges_t get_search_areas( fptr_t start, fptr_t end ) const;
 
+        /* index serialization, an index is loaded into an empty seeker
+         * and merged into the current one once complete */
+        size_t index_size() const;
+        bool save( FILE * ) const;
+        bool load( FILE * );
+        void merge( SegmentSeeker const& );
+
     public:
         ranges_t            _ranges_searched;
         tracks_seekpoints_t _tracks_seekpoints;
@@ -81,6 +81,10 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback") );
 
+    add_bool( "mkv-seek-index-cache", true,
+            N_("Cache seek index"),
+            N_("Keep the seek points found in local files without Cues, to seek faster the next time they are opened.") );
+
     add_shortcut( "mka", "mkv" )
     add_file_extension("mka")
     add_file_extension("mks")
@@ -150,6 +154,7 @@ static int OpenInternal( demux_t *p_demux, bool trust_cues )
     for (size_t i=0; i<p_stream->segments.size(); i++)
     {
         p_stream->segments[i]->Preload();
+        p_stream->segments[i]->LoadSeekIndex();
         b_need_preload |= p_stream->segments[i]->b_ref_external_segments;
         if ( p_stream->segments[i]->translations.size() &&
              p_stream->segments[i]->translations[0]->codec_id == MATROSKA_CHAPTER_CODEC_DVD &&
@@ -301,6 +306,9 @@ static void Close( vlc_object_t *p_this )
             p_segment->ESDestroy();
     }
 
+    for( size_t i = 0; i < p_sys->opened_segments.size(); i++ )
+        p_sys->opened_segments[i]->StoreSeekIndex();
+
     delete p_sys;
 }
 
@@ -323,7 +331,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     switch( i_query )
     {
         case DEMUX_CAN_SEEK:
-            return vlc_stream_vaControl( p_demux->s, i_query, args );
+            *va_arg( args, bool * ) = p_sys->b_seekable;
+            return VLC_SUCCESS;
 
         case DEMUX_GET_ATTACHMENTS:
             ppp_attach = va_arg( args, input_attachment_t*** );
@@ -479,6 +488,9 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
         case DEMUX_SET_PAUSE_STATE:
         case DEMUX_CAN_CONTROL_PACE:
         case DEMUX_GET_PTS_DELAY:
+            /* the stream cannot be used while clusters are read ahead */
+            for( size_t i = 0; i < p_sys->streams.size(); i++ )
+                p_sys->streams[i]->io_callback.Sync();
             return demux_vaControlHelper( p_demux->s, 0, -1, 0, 1, i_query, args );
 
         default:
@@ -525,7 +537,10 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_mk_date, double f_percent, virtu
     return p_vsegment->Seek( *p_demux, i_mk_date, p_vchapter, b_precise ) ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
-/* Needed by matroska_segment::Seek() and Seek */
+/* Needed by matroska_segment::Seek() and Seek
+ * The data of a block holding a single frame may be handed over to the
+ * es_out block, after which the frame list of the Kax block is dangling:
+ * the caller must only delete the element afterwards. */
 void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock,
                   KaxBlockAdditions *additions,
                   vlc_tick_t i_pts, int64_t i_duration, bool b_key_picture,
@@ -588,15 +603,26 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
             break;
         }
         size_t extra_data = track.fmt.i_codec == VLC_CODEC_PRORES ? 8 : 0;
-
-        if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+        const bool b_header_stripping =
+            track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
             track.p_compression_data != NULL &&
-            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
-            p_block = MemToBlock( data->Buffer(), data->Size(), track.p_compression_data->GetSize() + extra_data );
-        else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
+            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES;
+
+        if( unlikely( !b_header_stripping && track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
             p_block = packetize_wavpack( track, data->Buffer(), data->Size() );
         else
-            p_block = MemToBlock( data->Buffer(), data->Size(), extra_data );
+        {
+            if( b_header_stripping )
+                extra_data += track.p_compression_data->GetSize();
+
+            /* avoid copying frames that are alone in their block: the block
+             * then owns the frame data, and the frame list of internal_block
+             * must not be used after this point */
+            if( InternalBlockIsTakeable( internal_block, extra_data ) )
+                p_block = InternalBlockToBlock( internal_block, extra_data );
+            else
+                p_block = MemToBlock( data->Buffer(), data->Size(), extra_data );
+        }
 
         if( p_block == NULL )
         {
@@ -613,8 +639,7 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
         }
         else
 #endif
-        if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
-            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+        if( b_header_stripping )
         {
             memcpy( p_block->p_buffer, track.p_compression_data->GetBuffer(), track.p_compression_data->GetSize() );
         }
@@ -30,8 +30,202 @@ namespace mkv {
  *****************************************************************************/
 vlc_stream_io_callback::vlc_stream_io_callback( stream_t *s_, bool b_owner_ )
                        : s( s_), b_owner( b_owner_ )
+                       , b_ahead( false ), p_interrupt( NULL )
+                       , p_ahead( NULL ), pp_ahead_last( &p_ahead )
+                       , i_ahead_pos( 0 ), i_fetch_pos( 0 ), i_fetch_end( 0 )
+                       , b_fetching( false ), b_stop( false )
+                       , i_cur_pos( 0 ), p_cur( NULL ), i_cur_start( 0 )
 {
     mb_eof = false;
+    vlc_mutex_init( &lock );
+    vlc_cond_init( &wait );
+}
+
+void vlc_stream_io_callback::DropReadAhead( void )
+{
+    assert( p_interrupt == NULL );
+    block_ChainRelease( p_ahead );
+    p_ahead = NULL;
+    pp_ahead_last = &p_ahead;
+    p_cur = NULL;
+    b_ahead = false;
+}
+
+void vlc_stream_io_callback::FetchThread( void )
+{
+    vlc_interrupt_set( p_interrupt );
+
+    vlc_mutex_lock( &lock );
+    while( !b_stop && i_fetch_pos < i_fetch_end )
+    {
+        vlc_mutex_unlock( &lock );
+        /* keep the blocks of the stream as they are, without copying */
+        block_t *p_block = vlc_stream_ReadBlock( s );
+        vlc_mutex_lock( &lock );
+
+        if( p_block == NULL )
+            break;
+
+        i_fetch_pos += p_block->i_buffer;
+        block_ChainLastAppend( &pp_ahead_last, p_block );
+        vlc_cond_signal( &wait );
+    }
+    b_fetching = false;
+    vlc_cond_signal( &wait );
+    vlc_mutex_unlock( &lock );
+}
+
+void *vlc_stream_io_callback::FetchThread( void *data )
+{
+    static_cast<vlc_stream_io_callback *>( data )->FetchThread();
+    return NULL;
+}
+
+bool vlc_stream_io_callback::StartFetch( void )
+{
+    /* the previous thread reached the end of its range */
+    StopFetch();
+
+    p_interrupt = vlc_interrupt_create();
+    if( unlikely( p_interrupt == NULL ) )
+        return false;
+
+    b_fetching = true;
+    b_stop = false;
+    if( vlc_clone( &thread, FetchThread, this, VLC_THREAD_PRIORITY_INPUT ) )
+    {
+        vlc_interrupt_destroy( p_interrupt );
+        p_interrupt = NULL;
+        b_fetching = false;
+        return false;
+    }
+    return true;
+}
+
+void vlc_stream_io_callback::StopFetch( void )
+{
+    if( p_interrupt == NULL )
+        return;
+
+    vlc_mutex_lock( &lock );
+    b_stop = true;
+    vlc_mutex_unlock( &lock );
+
+    void *data[2];
+    vlc_interrupt_forward_start( p_interrupt, data );
+    vlc_join( thread, NULL );
+    vlc_interrupt_forward_stop( data );
+
+    vlc_interrupt_destroy( p_interrupt );
+    p_interrupt = NULL;
+}
+
+void vlc_stream_io_callback::Sync( void )
+{
+    if( !b_ahead )
+        return;
+
+    StopFetch();
+    DropReadAhead();
+
+    /* the stream is positioned after the data read ahead */
+    if( i_cur_pos != i_fetch_pos )
+        mb_eof = vlc_stream_Seek( s, i_cur_pos ) != VLC_SUCCESS;
+}
+
+bool vlc_stream_io_callback::ReadAhead( uint64_t i_size )
+{
+    if( mb_eof || s == NULL )
+        return false;
+
+    i_size = __MIN( i_size, READAHEAD_MAX );
+
+    if( b_ahead )
+    {
+        vlc_mutex_lock( &lock );
+        bool b_extend = i_cur_pos + i_size > i_fetch_end;
+        if( b_extend )
+        {
+            /* release what was consumed, except the last block */
+            while( p_ahead != NULL && p_ahead->p_next != NULL &&
+                   i_ahead_pos + p_ahead->i_buffer <= i_cur_pos )
+            {
+                block_t *p_next = p_ahead->p_next;
+                i_ahead_pos += p_ahead->i_buffer;
+                block_Release( p_ahead );
+                p_ahead = p_next;
+            }
+            p_cur = NULL;
+            i_fetch_end = i_cur_pos + i_size;
+        }
+        bool b_restart = b_extend && !b_fetching;
+        vlc_mutex_unlock( &lock );
+
+        return !b_restart || StartFetch();
+    }
+
+    uint64_t i_pos = vlc_stream_Tell( s );
+    uint64_t i_stream_size = stream_Size( s );
+    if( i_stream_size != 0 )
+    {
+        if( i_pos >= i_stream_size )
+            return false;
+        i_size = __MIN( i_size, i_stream_size - i_pos );
+    }
+
+    i_ahead_pos = i_fetch_pos = i_cur_pos = i_pos;
+    i_fetch_end = i_pos + i_size;
+    b_ahead = true;
+    if( !StartFetch() )
+    {
+        DropReadAhead();
+        return false;
+    }
+    return true;
+}
+
+/* Copies the data read ahead at the read position, waiting for the fetch
+ * thread if needed. Returns 0 once the read position is past its data. */
+size_t vlc_stream_io_callback::ReadAheadData( uint8_t *p_buffer, size_t i_size )
+{
+    vlc_mutex_lock( &lock );
+    if( i_fetch_pos <= i_cur_pos && b_fetching )
+    {
+        /* forward interruptions, so that a stalled fetch does not block */
+        void *data[2];
+        vlc_interrupt_forward_start( p_interrupt, data );
+        do
+            vlc_cond_wait( &wait, &lock );
+        while( i_fetch_pos <= i_cur_pos && b_fetching );
+        vlc_mutex_unlock( &lock );
+        vlc_interrupt_forward_stop( data );
+        vlc_mutex_lock( &lock );
+    }
+    uint64_t i_avail = i_fetch_pos > i_cur_pos ? i_fetch_pos - i_cur_pos : 0;
+    if( p_cur == NULL || i_cur_pos < i_cur_start )
+    {
+        p_cur = p_ahead;
+        i_cur_start = i_ahead_pos;
+    }
+    vlc_mutex_unlock( &lock );
+
+    /* the blocks before i_fetch_pos are not modified by the fetch thread */
+    size_t i_copy = __MIN( i_size, i_avail );
+    for( size_t i_done = 0; i_done < i_copy; )
+    {
+        while( i_cur_pos >= i_cur_start + p_cur->i_buffer )
+        {
+            i_cur_start += p_cur->i_buffer;
+            p_cur = p_cur->p_next;
+        }
+
+        size_t i_offset = i_cur_pos - i_cur_start;
+        size_t i_chunk = __MIN( i_copy - i_done, p_cur->i_buffer - i_offset );
+        memcpy( &p_buffer[i_done], &p_cur->p_buffer[i_offset], i_chunk );
+        i_done += i_chunk;
+        i_cur_pos += i_chunk;
+    }
+    return i_copy;
 }
 
 uint32 vlc_stream_io_callback::read( void *p_buffer, size_t i_size )
@@ -39,14 +233,31 @@ uint32 vlc_stream_io_callback::read( void *p_buffer, size_t i_size )
     if( i_size <= 0 || mb_eof )
         return 0;
 
-    int i_ret = vlc_stream_Read( s, p_buffer, i_size );
-    return i_ret < 0 ? 0 : i_ret;
+    uint8_t *p_dst = static_cast<uint8_t *>( p_buffer );
+    size_t i_copy = 0;
+    while( b_ahead && i_copy < i_size )
+    {
+        size_t i_ret = ReadAheadData( &p_dst[i_copy], i_size - i_copy );
+        if( i_ret == 0 )
+        {
+            /* past the range read ahead, continue from the stream */
+            Sync();
+            if( mb_eof )
+                return i_copy;
+        }
+        i_copy += i_ret;
+    }
+    if( i_copy == i_size )
+        return i_copy;
+
+    int i_ret = vlc_stream_Read( s, &p_dst[i_copy], i_size - i_copy );
+    return i_copy + ( i_ret < 0 ? 0 : i_ret );
 }
 
 void vlc_stream_io_callback::setFilePointer(int64_t i_offset, seek_mode mode )
 {
     int64_t i_pos, i_size;
-    int64_t i_current = vlc_stream_Tell( s );
+    int64_t i_current = getFilePointer();
 
     switch( mode )
     {
@@ -54,6 +265,7 @@ void vlc_stream_io_callback::setFilePointer(int64_t i_offset, seek_mode mode )
             i_pos = i_offset;
             break;
         case seek_end:
+            Sync();
             i_pos = stream_Size( s ) - i_offset;
             break;
         default:
@@ -61,6 +273,27 @@ void vlc_stream_io_callback::setFilePointer(int64_t i_offset, seek_mode mode )
             break;
     }
 
+    if( b_ahead )
+    {
+        if( i_pos >= 0 && static_cast<uint64_t>( i_pos ) >= i_ahead_pos )
+        {
+            /* positions not received yet are waited for by read() */
+            vlc_mutex_lock( &lock );
+            bool b_inside = static_cast<uint64_t>( i_pos ) <= i_fetch_pos ||
+                            ( b_fetching && static_cast<uint64_t>( i_pos ) < i_fetch_end );
+            vlc_mutex_unlock( &lock );
+            if( b_inside )
+            {
+                i_cur_pos = i_pos;
+                mb_eof = false;
+                return;
+            }
+        }
+        StopFetch();
+        DropReadAhead();
+        i_current = i_fetch_pos;
+    }
+
     if(i_pos == i_current)
     {
         if (mb_eof)
@@ -91,6 +324,8 @@ uint64 vlc_stream_io_callback::getFilePointer( void )
 {
     if ( s == NULL )
         return 0;
+    if( b_ahead )
+        return i_cur_pos;
     return vlc_stream_Tell( s );
 }
 
@@ -106,12 +341,13 @@ uint64 vlc_stream_io_callback::toRead( void )
     if( s == NULL)
         return 0;
 
+    Sync();
     i_size = stream_Size( s );
 
     if( i_size <= 0 )
         return UINT64_MAX;
 
-    return static_cast<uint64>( i_size - vlc_stream_Tell( s ) );
+    return static_cast<uint64>( i_size - getFilePointer() );
 }
 
 } // namespace
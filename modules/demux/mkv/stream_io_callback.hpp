@@ -29,6 +29,9 @@
 #endif
 
 #include <vlc_demux.h>
+#include <vlc_block.h>
+#include <vlc_threads.h>
+#include <vlc_interrupt.h>
 
 #include "ebml/IOCallback.h"
 
@@ -46,17 +49,62 @@ class vlc_stream_io_callback: public IOCallback
     bool           mb_eof;
     bool           b_owner;
 
+    /* blocks read ahead by the fetch thread: p_ahead->p_buffer[0] is at
+     * i_ahead_pos in the file, and the chain ends at i_fetch_pos, where the
+     * stream is positioned. The thread reads until i_fetch_end. */
+    bool           b_ahead;
+    vlc_mutex_t    lock;
+    vlc_cond_t     wait;
+    vlc_thread_t   thread;
+    vlc_interrupt_t *p_interrupt;
+    block_t        *p_ahead;
+    block_t        **pp_ahead_last;
+    uint64_t       i_ahead_pos;
+    uint64_t       i_fetch_pos;
+    uint64_t       i_fetch_end;
+    bool           b_fetching;
+    bool           b_stop;
+
+    /* read position within the data read ahead, and a block at or before
+     * it, starting at i_cur_start */
+    uint64_t       i_cur_pos;
+    block_t        *p_cur;
+    uint64_t       i_cur_start;
+
+    void FetchThread( void );
+    static void *FetchThread( void * );
+    bool StartFetch( void );
+    void StopFetch( void );
+    void DropReadAhead( void );
+    size_t ReadAheadData( uint8_t *, size_t );
+
   public:
+    /* largest amount of data read in advance at once */
+    static const size_t READAHEAD_MAX = 32 * 1024 * 1024;
+
     vlc_stream_io_callback( stream_t *, bool owner );
 
     virtual ~vlc_stream_io_callback()
     {
+        if( p_interrupt )
+            vlc_interrupt_kill( p_interrupt );
+        StopFetch();
+        DropReadAhead();
         if( b_owner )
             vlc_stream_Delete( s );
     }
 
     bool IsEOF() const { return mb_eof; }
 
+    /* Starts reading the next i_size bytes in the background. The following
+     * reads and seeks within that range are served from memory, waiting
+     * only for the data not received yet */
+    bool ReadAhead( uint64_t i_size );
+
+    /* Stops reading ahead and positions the stream at the read position.
+     * This must be called before using the stream directly. */
+    void Sync( void );
+
     virtual uint32   read            ( void *p_buffer, size_t i_size);
     virtual void     setFilePointer  ( int64_t i_offset, seek_mode mode = seek_beginning );
     virtual size_t   write           ( const void *p_buffer, size_t i_size);
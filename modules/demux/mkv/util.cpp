@@ -164,6 +164,52 @@ block_t *MemToBlock( uint8_t *p_mem, size_t i_mem, size_t offset)
     return p_block;
 }
 
+/* Utility function for BlockDecode: tells whether InternalBlockToBlock()
+ * can take over the buffer of a block holding a single frame, with offset
+ * bytes of the block header before that frame. */
+bool InternalBlockIsTakeable( KaxInternalBlock & internal_block, size_t offset )
+{
+    if( internal_block.NumberFrames() != 1 )
+        return false;
+
+    EbmlBinary & binary = internal_block;
+    DataBuffer & data = internal_block.GetBuffer( 0 );
+    const uint8_t *p_mem = binary.GetBuffer();
+    uint64 i_mem = binary.GetSize();
+
+    return p_mem != NULL && data.Buffer() >= p_mem && i_mem <= UINT32_MAX &&
+           static_cast<size_t>( data.Buffer() - p_mem ) >= offset &&
+           static_cast<uint64>( data.Buffer() - p_mem ) + data.Size() <= i_mem;
+}
+
+/* Utility function for BlockDecode: takes over the buffer libebml read the
+ * block into, which must be takeable. The frame list of the element still
+ * points into that buffer, which the returned block now owns. It must not be
+ * used anymore. On error, the frame is lost. */
+block_t *InternalBlockToBlock( KaxInternalBlock & internal_block, size_t offset )
+{
+    assert( InternalBlockIsTakeable( internal_block, offset ) );
+
+    /* libebml allocates the element data with malloc() */
+    EbmlBinary & binary = internal_block;
+    DataBuffer & data = internal_block.GetBuffer( 0 );
+    uint8_t *p_mem = binary.GetBuffer();
+    size_t i_mem = binary.GetSize();
+    uint8_t *p_frame = data.Buffer();
+    size_t i_frame = data.Size();
+
+    /* the element keeps its size, the parser still needs it to skip it */
+    binary.SetBuffer( NULL, static_cast<uint32>( i_mem ) );
+
+    block_t *p_block = block_heap_Alloc( p_mem, i_mem );
+    if( unlikely( p_block == NULL ) )
+        return NULL;
+
+    p_block->p_buffer = p_frame - offset;
+    p_block->i_buffer = i_frame + offset;
+    return p_block;
+}
+
 
 void handle_real_audio(demux_t * p_demux, mkv_track_t * p_tk, block_t * p_blk, vlc_tick_t i_pts)
 {
@@ -30,66 +30,153 @@ void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index )
     {
         free( p_index->pi_pos );
         free( p_index->p_times );
+        free( p_index->pb_sync );
         free( p_index );
     }
 }
 
+static bool MP4_Fragments_Index_Reserve( mp4_fragments_index_t *p_index, unsigned i_num )
+{
+    if( i_num <= p_index->i_alloc )
+        return true;
+    if( SIZE_MAX / i_num / sizeof(*p_index->p_times) < p_index->i_tracks )
+        return false;
+
+    uint64_t *pi_pos = realloc( p_index->pi_pos, sizeof(*pi_pos) * i_num );
+    if( !pi_pos )
+        return false;
+    p_index->pi_pos = pi_pos;
+
+    stime_t *p_times = realloc( p_index->p_times,
+                                sizeof(*p_times) * i_num * p_index->i_tracks );
+    if( !p_times )
+        return false;
+    p_index->p_times = p_times;
+
+    bool *pb_sync = realloc( p_index->pb_sync,
+                             sizeof(*pb_sync) * i_num * p_index->i_tracks );
+    if( !pb_sync )
+        return false;
+    p_index->pb_sync = pb_sync;
+
+    p_index->i_alloc = i_num;
+    return true;
+}
+
 mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_num )
 {
-    if( !i_tracks || !i_num || SIZE_MAX / i_num < i_tracks )
+    if( !i_tracks || !i_num )
         return NULL;
-    mp4_fragments_index_t *p_index = malloc( sizeof(*p_index) );
+    mp4_fragments_index_t *p_index = calloc( 1, sizeof(*p_index) );
     if( p_index )
     {
-        p_index->p_times = calloc( (size_t)i_num * i_tracks, sizeof(*p_index->p_times) );
-        p_index->pi_pos = calloc( i_num, sizeof(*p_index->pi_pos) );
-        if( !p_index->p_times || !p_index->pi_pos )
+        p_index->i_tracks = i_tracks;
+        if( !MP4_Fragments_Index_Reserve( p_index, i_num ) )
         {
             MP4_Fragments_Index_Delete( p_index );
             return NULL;
         }
-        p_index->i_entries = i_num;
-        p_index->i_last_time = 0;
-        p_index->i_tracks = i_tracks;
     }
     return p_index;
 }
 
-stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
-                                              unsigned i_track_index, uint64_t i_moof_pos )
+/* first entry with a position >= i_pos */
+static unsigned MP4_Fragments_Index_Find( const mp4_fragments_index_t *p_index, uint64_t i_pos )
 {
-    for( size_t i=0; i<p_index->i_entries; i++ )
+    unsigned i_low = 0, i_high = p_index->i_entries;
+    while( i_low < i_high )
+    {
+        unsigned i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->pi_pos[i_mid] < i_pos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+int MP4_Fragments_Index_Insert( mp4_fragments_index_t *p_index, uint64_t i_pos )
+{
+    unsigned i = MP4_Fragments_Index_Find( p_index, i_pos );
+    if( i < p_index->i_entries && p_index->pi_pos[i] == i_pos )
+        return i;
+
+    if( p_index->i_entries == INT_MAX ||
+        ( p_index->i_entries == p_index->i_alloc &&
+          !MP4_Fragments_Index_Reserve( p_index, p_index->i_alloc < INT_MAX / 2 ?
+                                                 p_index->i_alloc * 2 : INT_MAX ) ) )
+        return -1;
+
+    const unsigned i_tracks = p_index->i_tracks;
+    const size_t i_move = p_index->i_entries - i;
+    memmove( &p_index->pi_pos[i + 1], &p_index->pi_pos[i],
+             sizeof(*p_index->pi_pos) * i_move );
+    memmove( &p_index->p_times[(size_t)(i + 1) * i_tracks], &p_index->p_times[(size_t)i * i_tracks],
+             sizeof(*p_index->p_times) * i_move * i_tracks );
+    memmove( &p_index->pb_sync[(size_t)(i + 1) * i_tracks], &p_index->pb_sync[(size_t)i * i_tracks],
+             sizeof(*p_index->pb_sync) * i_move * i_tracks );
+
+    p_index->pi_pos[i] = i_pos;
+    for( unsigned j=0; j<i_tracks; j++ )
     {
-        if( p_index->pi_pos[i] >= i_moof_pos )
-            return p_index->p_times[i * p_index->i_tracks + i_track_index];
+        p_index->p_times[(size_t)i * i_tracks + j] = 0;
+        p_index->pb_sync[(size_t)i * i_tracks + j] = true;
     }
-    return 0;
+    p_index->i_entries++;
+    return i;
 }
 
-stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, unsigned i )
+bool MP4_Fragment_Index_GetTrackStartTime( const mp4_fragments_index_t *p_index,
+                                           unsigned i_track_index, uint64_t i_moof_pos,
+                                           stime_t *pi_time )
 {
+    unsigned i = MP4_Fragments_Index_Find( p_index, i_moof_pos );
+    if( i == p_index->i_entries || p_index->pi_pos[i] != i_moof_pos )
+        return false;
+    *pi_time = p_index->p_times[(size_t)i * p_index->i_tracks + i_track_index];
+    return true;
+}
+
+stime_t MP4_Fragment_Index_GetTrackDuration( const mp4_fragments_index_t *p_index, unsigned i )
+{
+    if( p_index->i_entries == 0 )
+        return 0;
     return p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks + i];
 }
 
-bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index, stime_t *pi_time,
+bool MP4_Fragments_Index_Lookup( const mp4_fragments_index_t *p_index, stime_t *pi_time,
                                  uint64_t *pi_pos, unsigned i_track_index )
 {
     if( *pi_time >= p_index->i_last_time || p_index->i_entries < 1 ||
         i_track_index >= p_index->i_tracks )
         return false;
 
-    for( size_t i=1; i<p_index->i_entries; i++ )
+    const unsigned i_tracks = p_index->i_tracks;
+
+    /* last fragment starting at or before the target */
+    unsigned i_low = 1, i_high = p_index->i_entries;
+    while( i_low < i_high )
+    {
+        unsigned i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->p_times[(size_t)i_mid * i_tracks + i_track_index] > *pi_time )
+            i_high = i_mid;
+        else
+            i_low = i_mid + 1;
+    }
+    unsigned i = i_low - 1;
+
+    /* then back to one starting with a sync sample, if any */
+    for( unsigned j = i + 1; j > 0; j-- )
     {
-        if( p_index->p_times[i * p_index->i_tracks + i_track_index] > *pi_time )
+        if( p_index->pb_sync[(size_t)(j - 1) * i_tracks + i_track_index] )
         {
-            *pi_time = p_index->p_times[(i - 1) * p_index->i_tracks + i_track_index];
-            *pi_pos = p_index->pi_pos[i - 1];
-            return true;
+            i = j - 1;
+            break;
         }
     }
 
-    *pi_time = p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks];
-    *pi_pos = p_index->pi_pos[p_index->i_entries - 1];
+    *pi_time = p_index->p_times[(size_t)i * i_tracks + i_track_index];
+    *pi_pos = p_index->pi_pos[i];
     return true;
 }
 
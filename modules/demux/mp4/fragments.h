@@ -23,11 +23,16 @@
 #include <vlc_common.h>
 #include "libmp4.h"
 
+/* Fragments start times, sorted by moof position. It is either built at
+ * once by probing the whole file, or grows as fragments are demuxed in
+ * file order, in which case it covers the file up to i_last_time. */
 typedef struct mp4_fragments_index_t
 {
     uint64_t *pi_pos;
     stime_t  *p_times; // movie scaled
+    bool     *pb_sync; // track starts with a sync sample in that fragment
     unsigned i_entries;
+    unsigned i_alloc;
     stime_t i_last_time; // movie scaled
     unsigned i_tracks;
 } mp4_fragments_index_t;
@@ -35,11 +40,17 @@ typedef struct mp4_fragments_index_t
 void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index );
 mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_num );
 
-stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
-                                              unsigned i_track_index, uint64_t i_moof_pos );
-stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, unsigned i_track_index );
+/* Returns the entry for the moof at i_pos, inserting an empty one if needed,
+ * or -1 on allocation failure */
+int MP4_Fragments_Index_Insert( mp4_fragments_index_t *p_index, uint64_t i_pos );
 
-bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index,
+bool MP4_Fragment_Index_GetTrackStartTime( const mp4_fragments_index_t *p_index,
+                                           unsigned i_track_index, uint64_t i_moof_pos,
+                                           stime_t *pi_time );
+stime_t MP4_Fragment_Index_GetTrackDuration( const mp4_fragments_index_t *p_index,
+                                             unsigned i_track_index );
+
+bool MP4_Fragments_Index_Lookup( const mp4_fragments_index_t *p_index,
                                  stime_t *pi_time, uint64_t *pi_pos, unsigned i_track_index );
 
 #ifdef MP4_VERBOSE
@@ -5222,7 +5222,7 @@ static const struct
     { 0,              MP4_ReadBox_default,   0 }
 };
 
-static int MP4_Box_Read_Specific( stream_t *p_stream, MP4_Box_t *p_box, MP4_Box_t *p_father )
+static int MP4_Box_Read_Payload( stream_t *p_stream, MP4_Box_t *p_box, MP4_Box_t *p_father )
 {
     int i_index;
 
@@ -5247,6 +5247,46 @@ static int MP4_Box_Read_Specific( stream_t *p_stream, MP4_Box_t *p_box, MP4_Box_
     return VLC_SUCCESS;
 }
 
+/* Sample tables are the bulk of a moov, and are only needed for the tracks
+ * which are actually played: in lazy mode, they're parsed on first access */
+static bool MP4_Box_IsDeferrable( const MP4_Box_t *p_box, const MP4_Box_t *p_father )
+{
+    if( !p_father || p_father->i_type != ATOM_stbl )
+        return false;
+
+    switch( p_box->i_type )
+    {
+        case ATOM_stts:
+        case ATOM_ctts:
+        case ATOM_stsc:
+        case ATOM_stsz:
+        case ATOM_stz2:
+        case ATOM_stco:
+        case ATOM_co64:
+        case ATOM_stss:
+        case ATOM_sdtp:
+            break;
+        default:
+            return false;
+    }
+
+    while( p_father->p_father )
+        p_father = p_father->p_father;
+    return p_father->i_type == ATOM_root && p_father->data.p_root != NULL;
+}
+
+static int MP4_Box_Read_Specific( stream_t *p_stream, MP4_Box_t *p_box, MP4_Box_t *p_father )
+{
+    if( MP4_Box_IsDeferrable( p_box, p_father ) )
+    {
+        /* the caller skips to the next box */
+        p_box->e_flags = BOX_FLAG_DEFERRED;
+        return VLC_SUCCESS;
+    }
+
+    return MP4_Box_Read_Payload( p_stream, p_box, p_father );
+}
+
 static MP4_Box_t *MP4_ReadBoxAllocateCheck( stream_t *p_stream, MP4_Box_t *p_father )
 {
     MP4_Box_t *p_box = calloc( 1, sizeof( MP4_Box_t ) ); /* Needed to ensure simple on error handler */
@@ -5319,6 +5359,62 @@ static MP4_Box_t *MP4_ReadBox( stream_t *p_stream, MP4_Box_t *p_father )
     return p_box;
 }
 
+/*****************************************************************************
+ * MP4_BoxLoadDeferred : parse a box skipped in lazy mode
+ *****************************************************************************
+ * The stream position is restored afterwards.
+ *****************************************************************************/
+static int MP4_BoxLoadDeferred( MP4_Box_t *p_box )
+{
+    const MP4_Box_t *p_root = p_box;
+    while( p_root->p_father )
+        p_root = p_root->p_father;
+    stream_t *p_stream = p_root->data.p_root->p_stream;
+
+    const uint64_t i_restore = vlc_stream_Tell( p_stream );
+    if( MP4_Seek( p_stream, p_box->i_pos ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    int i_ret = VLC_EGENERIC;
+    MP4_Box_t *p_tmp = MP4_ReadBoxAllocateCheck( p_stream, p_box->p_father );
+    if( p_tmp && p_tmp->i_type == p_box->i_type && p_tmp->i_size == p_box->i_size &&
+        MP4_Box_Read_Payload( p_stream, p_tmp, p_box->p_father ) == VLC_SUCCESS )
+    {
+        p_box->data = p_tmp->data;
+        p_box->pf_free = p_tmp->pf_free;
+        p_box->e_flags = p_tmp->e_flags;
+        p_tmp->data.p_payload = NULL;
+        p_tmp->pf_free = NULL;
+        i_ret = VLC_SUCCESS;
+    }
+    MP4_BoxFree( p_tmp );
+
+    if( MP4_Seek( p_stream, i_restore ) != VLC_SUCCESS )
+        msg_Err( p_stream, "cannot restore position after loading box %4.4s",
+                 (char *) &p_box->i_type );
+    return i_ret;
+}
+
+/* Unlinks and frees a box which could not be loaded */
+static void MP4_BoxDrop( MP4_Box_t *p_box )
+{
+    MP4_Box_t *p_father = p_box->p_father;
+    MP4_Box_t **pp_link = &p_father->p_first;
+    MP4_Box_t *p_prev = NULL;
+
+    while( *pp_link != p_box )
+    {
+        p_prev = *pp_link;
+        pp_link = &p_prev->p_next;
+    }
+    *pp_link = p_box->p_next;
+    if( p_father->p_last == p_box )
+        p_father->p_last = p_prev;
+
+    p_box->p_next = NULL;
+    MP4_BoxFree( p_box );
+}
+
 /*****************************************************************************
  * MP4_BoxNew : creates and initializes an arbitrary box
  *****************************************************************************/
@@ -5394,7 +5490,7 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t *s )
  *  The first box is a virtual box "root" and is the father for all first
  *  level boxes for the file, a sort of virtual container
  *****************************************************************************/
-MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream )
+MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream, bool b_lazy )
 {
     int i_result;
 
@@ -5403,6 +5499,17 @@ MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream )
         return NULL;
 
     p_vroot->i_shortsize = 1;
+
+    bool b_canseek;
+    if( b_lazy &&
+        vlc_stream_Control( p_stream, STREAM_CAN_SEEK, &b_canseek ) == VLC_SUCCESS &&
+        b_canseek )
+    {
+        p_vroot->data.p_root = malloc( sizeof(*p_vroot->data.p_root) );
+        if( p_vroot->data.p_root )
+            p_vroot->data.p_root->p_stream = p_stream;
+    }
+
     uint64_t i_size;
     if( vlc_stream_GetSize( p_stream, &i_size ) == 0 )
         p_vroot->i_size = i_size;
@@ -5511,7 +5618,8 @@ static void MP4_BoxDumpStructure_Internal( stream_t *s, const MP4_Box_t *p_box,
         snprintf( &str[i_level * 4], sizeof(str) - 4*i_level,
                   "+ %4.4s size %"PRIu64" offset %"PRIu64"%s",
                   (char *)&i_displayedtype, p_box->i_size, p_box->i_pos,
-                  p_box->e_flags & BOX_FLAG_INCOMPLETE ? " (\?\?\?\?)" : "" );
+                  p_box->e_flags == BOX_FLAG_INCOMPLETE ? " (\?\?\?\?)" :
+                  p_box->e_flags == BOX_FLAG_DEFERRED ? " (deferred)" : "" );
         msg_Dbg( s, "%s", str );
     }
     p_child = p_box->p_first;
@@ -5728,9 +5836,37 @@ MP4_Box_t *MP4_BoxGet( const MP4_Box_t *p_box, const char *psz_fmt, ... )
     MP4_BoxGet_Internal( &p_result, p_box, psz_fmt, args );
     va_end( args );
 
+    /* not parsed yet, see MP4_BoxLoad() */
+    if( p_result && p_result->e_flags == BOX_FLAG_DEFERRED )
+        return NULL;
+
     return( (MP4_Box_t *) p_result );
 }
 
+/*****************************************************************************
+ * MP4_BoxLoad: same as MP4_BoxGet, parsing the box if it was deferred
+ *****************************************************************************/
+VLC_FORMAT(2, 3)
+MP4_Box_t *MP4_BoxLoad( MP4_Box_t *p_box, const char *psz_fmt, ... )
+{
+    va_list args;
+    const MP4_Box_t *p_result;
+
+    va_start( args, psz_fmt );
+    MP4_BoxGet_Internal( &p_result, p_box, psz_fmt, args );
+    va_end( args );
+
+    MP4_Box_t *p_found = (MP4_Box_t *) p_result;
+    if( p_found && p_found->e_flags == BOX_FLAG_DEFERRED &&
+        MP4_BoxLoadDeferred( p_found ) != VLC_SUCCESS )
+    {
+        MP4_BoxDrop( p_found );
+        return NULL;
+    }
+
+    return p_found;
+}
+
 /*****************************************************************************
  * MP4_BoxCount: count box given a path relative to p_box
  *****************************************************************************
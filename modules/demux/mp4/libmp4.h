@@ -1706,6 +1706,12 @@ typedef struct MP4_Box_data__s
 
 */
 
+/* virtual root of a tree loaded in lazy mode */
+typedef struct
+{
+    stream_t *p_stream; /* to load deferred boxes from */
+} MP4_Box_data_root_t;
+
 typedef union MP4_Box_data_s
 {
     MP4_Box_data_ftyp_t *p_ftyp;
@@ -1820,6 +1826,8 @@ typedef union MP4_Box_data_s
     MP4_Box_data_ispe_t *p_ispe; /* heif */
     MP4_Box_data_ipma_t *p_ipma; /* heif */
 
+    MP4_Box_data_root_t *p_root;
+
     /* for generic handlers */
     MP4_Box_data_binary_t *p_binary;
     MP4_Box_data_data_t *p_data;
@@ -1844,6 +1852,7 @@ struct MP4_Box_s
     {
         BOX_FLAG_NONE = 0,
         BOX_FLAG_INCOMPLETE,
+        BOX_FLAG_DEFERRED, /* payload not parsed yet (lazy mode) */
     }            e_flags;
 
     UUID_t       i_uuid;  /* Set if i_type == "uuid" */
@@ -1908,8 +1917,11 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t * );
  *****************************************************************************
  *  The first box is a virtual box "root" and is the father for all first
  *  level boxes
+ *  In lazy mode, and if the stream can seek, the sample tables are only
+ *  parsed when first returned by MP4_BoxLoad. The stream must then outlive
+ *  the boxes.
  *****************************************************************************/
-MP4_Box_t *MP4_BoxGetRoot( stream_t * );
+MP4_Box_t *MP4_BoxGetRoot( stream_t *, bool b_lazy );
 
 /*****************************************************************************
  * MP4_BoxNew : Allocates a new MP4 Box with its atom type
@@ -1944,6 +1956,15 @@ void MP4_BoxDumpStructure( stream_t *p_input, const MP4_Box_t *p_box );
  *****************************************************************************/
 MP4_Box_t *MP4_BoxGet( const MP4_Box_t *p_box, const char *psz_fmt, ... );
 
+/*****************************************************************************
+ * MP4_BoxLoad: same as MP4_BoxGet, for boxes which can be deferred
+ *****************************************************************************
+ * MP4_BoxGet does not return boxes skipped in lazy mode. This parses them
+ * on first access, reading from the stream given to MP4_BoxGetRoot, or
+ * unlinks and frees them if that fails.
+ *****************************************************************************/
+MP4_Box_t *MP4_BoxLoad( MP4_Box_t *p_box, const char *psz_fmt, ... );
+
 /*****************************************************************************
  * MP4_BoxCount: find number of box given a path relative to p_box
  *****************************************************************************
@@ -127,6 +127,7 @@ typedef struct
         MP4_Box_t      *p_fragment_atom;
         uint64_t        i_post_mdat_offset;
         uint32_t        i_lastseqnumber;
+        bool            b_indexing; /* fragments are parsed in file order */
     } context;
 
     /* */
@@ -193,6 +194,7 @@ static int  ProbeFragmentsChecked( demux_t *p_demux );
 static int  ProbeIndex( demux_t *p_demux );
 
 static int FragCreateTrunIndex( demux_t *, MP4_Box_t *, MP4_Box_t *, stime_t );
+static void FragIndexMoof( demux_t *, MP4_Box_t * );
 
 static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t i_target_time,
                                    uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime );
@@ -346,104 +348,72 @@ static es_out_id_t * MP4_CreateES( es_out_t *out, const es_format_t *p_fmt,
     return p_es;
 }
 
-static int MP4_ChunkAllocDtsEntries( mp4_chunk_t *ck )
-{
-    size_t entries = ck->i_entries_dts;
-
-    if( entries <= ARRAY_SIZE(ck->small_dts_buf) / 2 )
-    {
-        ck->p_sample_count_dts = ck->small_dts_buf;
-        ck->p_sample_delta_dts = ck->small_dts_buf + entries;
-        return 0;
-    }
-
-    uint32_t *buf = calloc( entries, sizeof( buf[0] ) * 2 );
-    if( unlikely(buf == NULL) )
-        return VLC_ENOMEM;
-
-    ck->p_sample_count_dts = buf;
-    ck->p_sample_delta_dts = buf + entries;
-    return 0;
-}
-
-static int MP4_ChunkAllocPtsEntries( mp4_chunk_t *ck )
-{
-    size_t entries = ck->i_entries_pts;
-
-    if( entries <= ARRAY_SIZE(ck->small_pts_buf) / 2 )
-    {
-        ck->p_sample_count_pts = ck->small_pts_buf;
-        ck->p_sample_offset_pts = ck->small_pts_buf + entries;
-        return 0;
-    }
-
-    uint32_t *buf = calloc( entries, sizeof( buf[0] ) * 2 );
-    if( unlikely(buf == NULL) )
-        return VLC_ENOMEM;
-
-    ck->p_sample_count_pts = buf;
-    ck->p_sample_offset_pts = buf + entries;
-    return 0;
-}
-
-static void MP4_ChunkDestroy( mp4_chunk_t *ck )
-{
-    if( ck->p_sample_count_dts != ck->small_dts_buf )
-        free( ck->p_sample_count_dts );
-    if( ck->p_sample_count_pts != ck->small_pts_buf )
-        free( ck->p_sample_count_pts );
-}
-
 static const mp4_chunk_t * MP4_TrackChunkForSample( const mp4_track_t *p_track,
                                                     uint32_t i_sample )
 {
     if( i_sample >= p_track->i_sample_count )
         return NULL;
-    for( uint32_t i=0; i<p_track->i_chunk_count; i++ )
+    /* chunks are sorted by first sample */
+    uint32_t i_lo = 0, i_hi = p_track->i_chunk_count;
+    while( i_hi - i_lo > 1 )
     {
-        if( i_sample >= p_track->chunk[i].i_sample_first &&
-            i_sample - p_track->chunk[i].i_sample_first < p_track->chunk[i].i_sample_count )
-            return &p_track->chunk[i];
+        uint32_t i_mid = i_lo + (i_hi - i_lo) / 2;
+        if( p_track->chunk[i_mid].i_sample_first <= i_sample )
+            i_lo = i_mid;
+        else
+            i_hi = i_mid;
     }
+    if( i_lo < p_track->i_chunk_count &&
+        i_sample - p_track->chunk[i_lo].i_sample_first < p_track->chunk[i_lo].i_sample_count )
+        return &p_track->chunk[i_lo];
     return NULL;
 }
 
-static stime_t MP4_ChunkGetSampleDTS( const mp4_chunk_t *p_chunk,
+static stime_t MP4_ChunkGetSampleDTS( const mp4_track_t *p_track,
+                                      const mp4_chunk_t *p_chunk,
                                       uint32_t i_sample )
 {
-    uint32_t i_index = 0;
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
     stime_t sdts = p_chunk->i_first_dts;
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+    uint32_t i_skip = p_chunk->i_dts_skip;
+    for( uint32_t i_index = p_chunk->i_dts_entry;
+         i_sample > 0 && stts && i_index < stts->i_entry_count; i_index++ )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        uint32_t i_count = stts->pi_sample_count[i_index] - i_skip;
+        uint32_t i_delta = stts->pi_sample_delta[i_index];
+        i_skip = 0;
+        if( i_sample > i_count )
         {
-            sdts += (stime_t)p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index++];
+            sdts += (stime_t)i_count * i_delta;
+            i_sample -= i_count;
         }
         else
         {
-            sdts += (stime_t)i_sample * p_chunk->p_sample_delta_dts[i_index];
+            sdts += (stime_t)i_sample * i_delta;
             break;
         }
     }
     return sdts;
 }
 
-static bool MP4_ChunkGetSampleCTSDelta( const mp4_chunk_t *p_chunk,
+static bool MP4_ChunkGetSampleCTSDelta( const mp4_track_t *p_track,
+                                        const mp4_chunk_t *p_chunk,
                                         uint32_t i_sample, stime_t *pi_delta )
 {
-    if( p_chunk->p_sample_count_pts && p_chunk->p_sample_offset_pts )
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
+    if( ctts == NULL )
+        return false;
+
+    i_sample += p_chunk->i_pts_skip;
+    for( uint32_t i_index = p_chunk->i_pts_entry; i_index < ctts->i_entry_count; i_index++ )
     {
-        for( uint32_t i_index = 0; i_index < p_chunk->i_entries_pts ; i_index++ )
+        if( i_sample < ctts->pi_sample_count[i_index] )
         {
-            if( i_sample < p_chunk->p_sample_count_pts[i_index] )
-            {
-                *pi_delta = p_chunk->p_sample_offset_pts[i_index];
-                return true;
-            }
-            i_sample -= p_chunk->p_sample_count_pts[i_index];
+            int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + p_track->i_cts_shift;
+            *pi_delta = (uint32_t) __MAX(i_ctsdelta, 0); /* should not be < 0 */
+            return true;
         }
+        i_sample -= ctts->pi_sample_count[i_index];
     }
     return false;
 }
@@ -499,43 +469,13 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     VLC_UNUSED( p_demux );
 
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    stime_t i_duration = 0;
-
-    /* Forward to right index, and set remaining count in that index */
-    unsigned i_index = 0;
-    unsigned i_remain = 0;
-    for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
-    {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
-        {
-            i += p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            i_remain = p_track->i_sample - i;
-            break;
-        }
-    }
+    uint32_t i_first = p_track->i_sample - p_chunk->i_sample_first;
+    if( i_first >= p_chunk->i_sample_count )
+        return 0;
+    uint32_t i_last = i_first + __MIN(i_nb_samples, p_chunk->i_sample_count - i_first);
 
-    /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
-        {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
-            i_index++;
-            i_remain = 0;
-        }
-        else
-        {
-            i_duration += (stime_t)i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    stime_t i_duration = MP4_ChunkGetSampleDTS( p_track, p_chunk, i_last ) -
+                         MP4_ChunkGetSampleDTS( p_track, p_chunk, i_first );
 
     return MP4_rescale_mtime( i_duration, p_track->i_timescale );
 }
@@ -551,8 +491,11 @@ static int LoadInitFrag( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
-    /* Load all boxes ( except raw data ) */
-    MP4_Box_t *p_root = MP4_BoxGetRoot( p_demux->s );
+    /* Load all boxes ( except raw data ). Sample tables are only parsed
+     * on access when that does not cost extra requests */
+    bool b_fastseek = false;
+    vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseek );
+    MP4_Box_t *p_root = MP4_BoxGetRoot( p_demux->s, b_fastseek );
     if( p_root == NULL || !MP4_BoxGet( p_root, "/moov" ) )
     {
         MP4_BoxFree( p_root );
@@ -1227,6 +1170,8 @@ static int Open( vlc_object_t * p_this )
     if( p_sys->b_fragmented )
     {
         p_demux->pf_demux = DemuxFrag;
+        /* playback starts from moov, then first fragment */
+        p_sys->context.b_indexing = true;
         msg_Dbg( p_demux, "Set Fragmented demux mode" );
     }
 
@@ -1825,7 +1770,8 @@ static int FragSeekLoadFragment( demux_t *p_demux, uint32_t i_moox, stime_t i_mo
 
     if( i_moox == ATOM_moof )
     {
-        FragPrepareChunk( p_demux, p_moox, NULL, i_moox_time, true );
+        if( FragPrepareChunk( p_demux, p_moox, NULL, i_moox_time, true ) == VLC_SUCCESS )
+            FragIndexMoof( p_demux, p_moox );
         p_sys->context.i_lastseqnumber = FragGetMoofSequenceNumber( p_moox );
 
         p_sys->i_nztime = FragGetDemuxTimeFromTracksTime( p_sys );
@@ -1943,23 +1889,29 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
             /* Does only provide segment position and a sync sample time */
             msg_Dbg( p_demux, "seeking to sync point %" PRId64, i_sync_time );
         }
-        else if( !p_sys->b_fragments_probed )
+        else if( !p_sys->b_fragments_probed &&
+                 ( !p_sys->p_fragsindex || p_sys->p_fragsindex->i_last_time <=
+                   MP4_rescale_qtime( i_sync_time, p_sys->i_timescale ) ) )
         {
+            /* not covered by the fragments demuxed so far */
             int i_ret = ProbeFragmentsChecked( p_demux );
             if( i_ret != VLC_SUCCESS )
                 return i_ret;
         }
 
-        if( p_sys->b_fragments_probed && p_sys->p_fragsindex )
+        if( p_sys->p_fragsindex )
         {
             stime_t i_basetime = MP4_rescale_qtime( i_sync_time, p_sys->i_timescale );
-            if( !MP4_Fragments_Index_Lookup( p_sys->p_fragsindex, &i_basetime, &i64, i_seek_track_index ) )
+            if( MP4_Fragments_Index_Lookup( p_sys->p_fragsindex, &i_basetime, &i64, i_seek_track_index ) )
+            {
+                msg_Dbg( p_demux, "seeking to fragment index pos %" PRId64 " %" PRId64, i64,
+                         MP4_rescale_mtime( i_basetime, p_sys->i_timescale ) );
+            }
+            else if( i64 == UINT64_MAX )
             {
                 p_sys->b_error = (vlc_stream_Seek( p_demux->s, i_backup_pos ) != VLC_SUCCESS);
                 return VLC_EGENERIC;
             }
-            msg_Dbg( p_demux, "seeking to fragment index pos %" PRId64 " %" PRId64, i64,
-                     MP4_rescale_mtime( i_basetime, p_sys->i_timescale ) );
         }
     }
 
@@ -1971,9 +1923,17 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
     }
 
     msg_Dbg( p_demux, "final seek to fragment at %"PRId64, i64 );
+
+    /* Keep growing the index only if we restart from a known fragment */
+    stime_t i_known;
+    p_sys->context.b_indexing = i_segment_type == ATOM_moov ||
+        ( p_sys->p_fragsindex &&
+          MP4_Fragment_Index_GetTrackStartTime( p_sys->p_fragsindex, 0, i64, &i_known ) );
+
     if( vlc_stream_Seek( p_demux->s, i64 ) )
     {
         msg_Err( p_demux, "seek failed to %"PRId64, i64 );
+        p_sys->context.b_indexing = false;
         p_sys->b_error = (vlc_stream_Seek( p_demux->s, i_backup_pos ) != VLC_SUCCESS);
         return VLC_EGENERIC;
     }
@@ -1981,6 +1941,7 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
     /* Context is killed on success */
     if( FragSeekLoadFragment( p_demux, i_segment_type, i_segment_time ) != VLC_SUCCESS )
     {
+        p_sys->context.b_indexing = false;
         p_sys->b_error = (vlc_stream_Seek( p_demux->s, i_backup_pos ) != VLC_SUCCESS);
         return VLC_EGENERIC;
     }
@@ -2426,9 +2387,9 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     unsigned int i_chunk;
     unsigned int i_index, i_last;
 
-    if( ( !(p_co64 = MP4_BoxGet( p_demux_track->p_stbl, "stco" ) )&&
-          !(p_co64 = MP4_BoxGet( p_demux_track->p_stbl, "co64" ) ) )||
-        ( !(p_stsc = MP4_BoxGet( p_demux_track->p_stbl, "stsc" ) ) ))
+    if( ( !(p_co64 = MP4_BoxLoad( p_demux_track->p_stbl, "stco" ) )&&
+          !(p_co64 = MP4_BoxLoad( p_demux_track->p_stbl, "co64" ) ) )||
+        ( !(p_stsc = MP4_BoxLoad( p_demux_track->p_stbl, "stsc" ) ) ))
     {
         return( VLC_EGENERIC );
     }
@@ -2453,12 +2414,8 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
 
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
+        ck->i_dts_entry = ck->i_dts_skip = 0;
+        ck->i_pts_entry = ck->i_pts_skip = 0;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2520,54 +2477,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
-{
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EINVAL;
-        }
-
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
-    }
-
-    return VLC_SUCCESS;
-}
-
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2578,9 +2487,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
     /* Find stsz or stz2
      *  Gives the sample size for each samples. */
-    p_box = MP4_BoxGet( p_demux_track->p_stbl, "stsz" );
+    p_box = MP4_BoxLoad( p_demux_track->p_stbl, "stsz" );
     if( !p_box )
-        p_box = MP4_BoxGet( p_demux_track->p_stbl, "stz2" );
+        p_box = MP4_BoxLoad( p_demux_track->p_stbl, "stz2" );
     if( !p_box )
     {
         msg_Warn( p_demux, "cannot find STSZ or STZ2 box" );
@@ -2605,18 +2514,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, use the table in place */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2629,20 +2529,17 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
     }
 
-    /* Use stts table to create a sample number -> dts table.
+    /* Use stts table to find each chunk dts.
      * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+     *  the box! so each chunk only remembers where its samples start in the
+     *  run-length table, which is walked from there (problem with raw stream
+     *  where a sample is sometime just channels*bits_per_sample/8) */
 
     int64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
-    p_box = MP4_BoxGet( p_demux_track->p_stbl, "stts" );
+    p_box = MP4_BoxLoad( p_demux_track->p_stbl, "stts" );
     if( !p_box )
     {
         msg_Warn( p_demux, "cannot find STTS box" );
@@ -2650,97 +2547,43 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        const MP4_Box_data_stts_t *stts = p_box->data.p_stts;
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
+        p_demux_track->p_stts = stts;
+
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_index_samples_used = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
+            uint32_t i_sample_count = ck->i_sample_count;
 
-            /* save first dts */
+            /* save first dts and table position */
             ck->i_first_dts = i_next_dts;
+            ck->i_dts_entry = i_index;
+            ck->i_dts_skip = i_index_samples_used;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocDtsEntries( ck );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
+            while( i_sample_count > 0 && i_index < stts->i_entry_count )
             {
-                if ( i_current_index_samples_left )
+                uint32_t i_count = __MIN( stts->pi_sample_count[i_index] - i_index_samples_used,
+                                          i_sample_count );
+                i_next_dts += (int64_t)i_count * stts->pi_sample_delta[i_index];
+                i_sample_count -= i_count;
+                i_index_samples_used += i_count;
+                if( i_index_samples_used == stts->pi_sample_count[i_index] )
                 {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_index_samples_used = 0;
                 }
-
             }
+
+            if( i_sample_count > 0 )
+                msg_Err( p_demux, "invalid index counting total samples %u %u",
+                         i_index, stts->i_entry_count );
+            ck->i_duration = i_next_dts - ck->i_first_dts;
         }
     }
 
@@ -2748,10 +2591,10 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     /* Find ctts
      *  Gives the delta between decoding time (dts) and composition table (pts)
      */
-    p_box = MP4_BoxGet( p_demux_track->p_stbl, "ctts" );
+    p_box = MP4_BoxLoad( p_demux_track->p_stbl, "ctts" );
     if( p_box && p_box->data.p_ctts )
     {
-        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        const MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
@@ -2770,84 +2613,32 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
             }
         }
 
-        /* Create pts-dts table per chunk */
+        p_demux_track->p_ctts = ctts;
+        p_demux_track->i_cts_shift = i_cts_shift;
+
+        /* Find each chunk position in the pts-dts table */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_index_samples_used = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocPtsEntries( ck );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return i_ret;
-            }
+            uint32_t i_sample_count = ck->i_sample_count;
 
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+            ck->i_pts_entry = i_index;
+            ck->i_pts_skip = i_index_samples_used;
 
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
+            while( i_sample_count > 0 && i_index < ctts->i_entry_count )
             {
-                int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                if( i_ctsdelta < 0 ) /* should not */
-                    i_ctsdelta = 0;
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
+                uint32_t i_count = __MIN( ctts->pi_sample_count[i_index] - i_index_samples_used,
+                                          i_sample_count );
+                i_sample_count -= i_count;
+                i_index_samples_used += i_count;
+                if( i_index_samples_used == ctts->pi_sample_count[i_index] )
                 {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_index_samples_used = 0;
                 }
-
-
             }
         }
     }
@@ -3073,7 +2864,7 @@ static int TrackGetNearestSeekPoint( demux_t *p_demux, mp4_track_t *p_track,
     *pi_sync_sample = 0;
 
     const MP4_Box_t *p_stss;
-    if( ( p_stss = MP4_BoxGet( p_track->p_stbl, "stss" ) ) )
+    if( ( p_stss = MP4_BoxLoad( p_track->p_stbl, "stss" ) ) )
     {
         const MP4_Box_data_stss_t *p_stss_data = BOXDATA(p_stss);
         msg_Dbg( p_demux, "track[Id 0x%x] using Sync Sample Box (stss)",
@@ -3189,52 +2980,45 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         i_start = MP4_rescale_qtime( start, p_track->i_timescale );
     }
 
-    /* we start from sample 0/chunk 0, hope it won't take too much time */
     /* *** find good chunk *** */
-    for( i_chunk = 0; ; i_chunk++ )
+    /* chunks are sorted by first dts, find the last one starting before */
+    uint32_t i_lo = 0, i_hi = p_track->i_chunk_count;
+    while( i_hi - i_lo > 1 )
     {
-        if( i_chunk + 1 >= p_track->i_chunk_count )
-        {
-            /* at the end and can't check if i_start in this chunk,
-               it will be check while searching i_sample */
-            i_chunk = p_track->i_chunk_count - 1;
-            break;
-        }
-
-        if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
-            (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
-        {
-            break;
-        }
+        uint32_t i_mid = i_lo + (i_hi - i_lo) / 2;
+        if( (uint64_t)i_start >= p_track->chunk[i_mid].i_first_dts )
+            i_lo = i_mid;
+        else
+            i_hi = i_mid;
     }
+    i_chunk = i_lo;
 
     /* *** find sample in the chunk *** */
-    i_sample = p_track->chunk[i_chunk].i_sample_first;
-    i_dts    = p_track->chunk[i_chunk].i_first_dts;
-
-    for( uint_fast32_t i_index = 0;
-         i_index < p_track->chunk[i_chunk].i_entries_dts &&
-         i_sample < p_track->chunk[i_chunk].i_sample_count;
+    const mp4_chunk_t *ck = &p_track->chunk[i_chunk];
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    uint32_t i_skip = ck->i_dts_skip;
+    uint32_t i_left = ck->i_sample_count;
+    i_sample = ck->i_sample_first;
+    i_dts    = ck->i_first_dts;
+
+    for( uint32_t i_index = ck->i_dts_entry;
+         stts && i_index < stts->i_entry_count && i_left > 0;
          i_index++ )
     {
-        if( i_dts +
-            (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
+        uint32_t i_count = __MIN( stts->pi_sample_count[i_index] - i_skip, i_left );
+        uint32_t i_delta = stts->pi_sample_delta[i_index];
+        i_skip = 0;
+        if( i_dts + (uint64_t)i_count * i_delta < (uint64_t)i_start )
         {
-            i_dts    +=
-                (uint64_t)p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
-
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
+            i_dts    += (uint64_t)i_count * i_delta;
+            i_sample += i_count;
+            i_left   -= i_count;
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
-            {
+            if( i_delta == 0 )
                 break;
-            }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            i_sample += ( i_start - i_dts ) / i_delta;
             break;
         }
     }
@@ -3384,8 +3168,7 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
     p_track->i_start_delta = p_track->i_next_delta;
 
     /* Probe the 16 first B frames */
-    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    if( p_chunk->i_entries_pts )
+    if( p_track->p_ctts )
     {
         for( uint32_t i=1; i<16; i++ )
         {
@@ -3394,9 +3177,9 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
             if(!ck)
                 break;
             stime_t pts;
-            stime_t dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
+            stime_t dts = pts = MP4_ChunkGetSampleDTS( p_track, ck, i_nextsample - ck->i_sample_first );
             stime_t delta = UNKNOWN_DELTA;
-            if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
+            if( MP4_ChunkGetSampleCTSDelta( p_track, ck, i_nextsample - ck->i_sample_first, &delta ) )
                 pts += delta;
             stime_t lowest = p_track->i_start_dts;
             if( p_track->i_start_delta != UNKNOWN_DELTA )
@@ -3414,9 +3197,9 @@ static void TrackUpdateSampleAndTimes( mp4_track_t *p_track )
 {
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
     uint32_t i_chunk_sample = p_track->i_sample - p_chunk->i_sample_first;
-    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_chunk, i_chunk_sample );
+    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_track, p_chunk, i_chunk_sample );
     stime_t i_next_delta;
-    if( !MP4_ChunkGetSampleCTSDelta( p_chunk, i_chunk_sample, &i_next_delta ) )
+    if( !MP4_ChunkGetSampleCTSDelta( p_track, p_chunk, i_chunk_sample, &i_next_delta ) )
         p_track->i_next_delta = UNKNOWN_DELTA;
     else
         p_track->i_next_delta = i_next_delta;
@@ -3709,16 +3492,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            MP4_ChunkDestroy( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     ASFPacketTrackReset( &p_track->asfinfo );
 
     free( p_track->context.runs.p_array );
@@ -4217,7 +3992,7 @@ static stime_t GetCumulatedDuration( demux_t *p_demux )
         const MP4_Box_t *p_stsz;
         const MP4_Box_t *p_tkhd;
         if ( (p_tkhd = MP4_BoxGet( p_trak, "tkhd" )) &&
-             (p_stsz = MP4_BoxGet( p_trak, "mdia/minf/stbl/stsz" )) &&
+             (p_stsz = MP4_BoxLoad( p_trak, "mdia/minf/stbl/stsz" )) &&
              /* duration might be wrong an be set to whole duration :/ */
              BOXDATA(p_stsz)->i_sample_count > 0 )
         {
@@ -4279,7 +4054,7 @@ static stime_t GetMoovTrackDuration( demux_sys_t *p_sys, unsigned i_track_ID )
     const MP4_Box_t *p_stsz;
     const MP4_Box_t *p_tkhd;
     if ( (p_tkhd = MP4_BoxGet( p_trak, "tkhd" )) &&
-         (p_stsz = MP4_BoxGet( p_trak, "mdia/minf/stbl/stsz" )) &&
+         (p_stsz = MP4_BoxLoad( p_trak, "mdia/minf/stbl/stsz" )) &&
          /* duration might be wrong an be set to whole duration :/ */
          BOXDATA(p_stsz)->i_sample_count > 0 )
     {
@@ -4375,6 +4150,85 @@ static bool GetMoofTrackDuration( MP4_Box_t *p_moov, MP4_Box_t *p_moof,
     return true;
 }
 
+/* ISO/IEC 14496-12 sample_is_non_sync_sample */
+#define MP4_SAMPLE_FLAG_NON_SYNC (1 << 16)
+
+static bool FragTrafStartsWithSync( MP4_Box_t *p_moov, MP4_Box_t *p_traf )
+{
+    const MP4_Box_t *p_tfhd = MP4_BoxGet( p_traf, "tfhd" );
+    const MP4_Box_t *p_trun = MP4_BoxGet( p_traf, "trun" );
+    if( !p_tfhd || !p_trun || !BOXDATA(p_tfhd) || !BOXDATA(p_trun) ||
+        !BOXDATA(p_trun)->i_sample_count )
+        return false;
+
+    uint32_t i_flags = 0;
+    if( BOXDATA(p_trun)->i_flags & MP4_TRUN_FIRST_FLAGS )
+        i_flags = BOXDATA(p_trun)->i_first_sample_flags;
+    else if( BOXDATA(p_trun)->i_flags & MP4_TRUN_SAMPLE_FLAGS )
+        i_flags = BOXDATA(p_trun)->p_samples[0].i_flags;
+    else if( BOXDATA(p_tfhd)->i_flags & MP4_TFHD_DFLT_SAMPLE_FLAGS )
+        i_flags = BOXDATA(p_tfhd)->i_default_sample_flags;
+    else
+    {
+        const MP4_Box_t *p_trex = MP4_GetTrexByTrackID( p_moov, BOXDATA(p_tfhd)->i_track_ID );
+        if( p_trex && BOXDATA(p_trex) )
+            i_flags = BOXDATA(p_trex)->i_default_sample_flags;
+    }
+
+    return !(i_flags & MP4_SAMPLE_FLAG_NON_SYNC);
+}
+
+/* Adds a fragment being demuxed to the index, as long as all
+ * the previous ones have been (file order playback) */
+static void FragIndexMoof( demux_t *p_demux, MP4_Box_t *p_moof )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->b_seekable || !p_sys->context.b_indexing || p_sys->b_fragments_probed )
+        return;
+
+    if( !p_sys->p_fragsindex )
+    {
+        p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, 64 );
+        if( !p_sys->p_fragsindex )
+            return;
+    }
+    mp4_fragments_index_t *p_index = p_sys->p_fragsindex;
+
+    if( p_index->i_entries &&
+        p_index->pi_pos[p_index->i_entries - 1] >= p_moof->i_pos )
+        return; /* already known */
+
+    const int index = MP4_Fragments_Index_Insert( p_index, p_moof->i_pos );
+    if( index < 0 )
+    {
+        p_sys->context.b_indexing = false;
+        return;
+    }
+
+    for( unsigned i=0; i<p_sys->i_tracks; i++ )
+    {
+        const mp4_track_t *p_track = &p_sys->track[i];
+        MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_track->i_track_ID );
+
+        stime_t i_start = p_track->context.runs.i_count ?
+                          p_track->context.runs.p_array[0].i_first_dts : p_track->i_time;
+        p_index->p_times[(size_t)index * p_sys->i_tracks + i] =
+                MP4_rescale( i_start, p_track->i_timescale, p_sys->i_timescale );
+        p_index->pb_sync[(size_t)index * p_sys->i_tracks + i] =
+                p_traf && FragTrafStartsWithSync( p_sys->p_moov, p_traf );
+
+        stime_t i_duration = 0;
+        if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_track->i_track_ID, &i_duration ) )
+        {
+            stime_t i_end = MP4_rescale( i_start + i_duration,
+                                         p_track->i_timescale, p_sys->i_timescale );
+            if( p_index->i_last_time < i_end )
+                p_index->i_last_time = i_end;
+        }
+    }
+}
+
 static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -4396,29 +4250,40 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
         if( i_moof )
         {
             *pb_fragmented = true;
-            p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, i_moof );
+            if( !p_sys->p_fragsindex )
+                p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, i_moof );
             if( !p_sys->p_fragsindex )
             {
                 MP4_BoxFree( p_vroot );
                 return VLC_EGENERIC;
             }
+            mp4_fragments_index_t *p_index = p_sys->p_fragsindex;
 
             stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
             if( !pi_track_times )
             {
-                MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
-                p_sys->p_fragsindex = NULL;
                 MP4_BoxFree( p_vroot );
                 return VLC_EGENERIC;
             }
 
-            unsigned index = 0;
+            /* Continue from the fragments already indexed while demuxing */
+            const bool b_first = ( p_index->i_entries == 0 );
+            if( !b_first )
+            {
+                for( unsigned i=0; i<p_sys->i_tracks; i++ )
+                    pi_track_times[i] = MP4_rescale( MP4_Fragment_Index_GetTrackDuration( p_index, i ),
+                                                     p_sys->i_timescale, p_sys->track[i].i_timescale );
+            }
 
             for( MP4_Box_t *p_moof = p_vroot->p_first; p_moof; p_moof = p_moof->p_next )
             {
                 if( p_moof->i_type != ATOM_moof )
                     continue;
 
+                const int index = MP4_Fragments_Index_Insert( p_index, p_moof->i_pos );
+                if( index < 0 )
+                    break;
+
                 for( unsigned i=0; i<p_sys->i_tracks; i++ )
                 {
                     MP4_Box_t *p_tfdt = NULL;
@@ -4430,33 +4295,34 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
                     {
                         pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
                     }
-                    else if( index == 0 ) /* Set first fragment time offset from moov */
+                    else if( b_first && p_moof == MP4_BoxGet( p_vroot, "moof" ) )
                     {
+                        /* Set first fragment time offset from moov */
                         stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
                         pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
                     }
 
                     stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                    p_sys->p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
+                    p_index->p_times[(size_t)index * p_sys->i_tracks + i] = i_movietime;
+                    p_index->pb_sync[(size_t)index * p_sys->i_tracks + i] =
+                            p_traf && FragTrafStartsWithSync( p_sys->p_moov, p_traf );
 
                     stime_t i_duration = 0;
                     if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
                         pi_track_times[i] += i_duration;
                 }
-
-                p_sys->p_fragsindex->pi_pos[index++] = p_moof->i_pos;
             }
 
             for( unsigned i=0; i<p_sys->i_tracks; i++ )
             {
                 stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                if( p_sys->p_fragsindex->i_last_time < i_movietime )
-                    p_sys->p_fragsindex->i_last_time = i_movietime;
+                if( p_index->i_last_time < i_movietime )
+                    p_index->i_last_time = i_movietime;
             }
 
             free( pi_track_times );
 #ifdef MP4_VERBOSE
-            MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
+            MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_index, p_sys->i_timescale );
 #endif
         }
     }
@@ -4510,8 +4376,13 @@ static int ProbeFragmentsChecked( demux_t *p_demux )
             return VLC_EGENERIC;
     }
 
+    /* Fragments demuxed so far are already indexed */
+    uint64_t i_probe_pos = p_sys->p_moov->i_pos + p_sys->p_moov->i_size;
+    if( p_sys->p_fragsindex && p_sys->p_fragsindex->i_entries )
+        i_probe_pos = p_sys->p_fragsindex->pi_pos[p_sys->p_fragsindex->i_entries - 1];
+
     const uint64_t i_backup_pos = vlc_stream_Tell( p_demux->s );
-    int i_ret = vlc_stream_Seek( p_demux->s, p_sys->p_moov->i_pos + p_sys->p_moov->i_size );
+    int i_ret = vlc_stream_Seek( p_demux->s, i_probe_pos );
     if( i_ret == VLC_SUCCESS )
     {
         bool foo;
@@ -4831,16 +4702,19 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
                 }
             }
 
-            /* After seek we should have probed fragments */
+            /* After seek we should have indexed that fragment */
             if( !b_has_base_media_decode_time && p_sys->p_fragsindex )
             {
                 unsigned i_track_index = (p_track - p_sys->track);
                 assert(&p_sys->track[i_track_index] == p_track);
-                i_traf_start_time = MP4_Fragment_Index_GetTrackStartTime( p_sys->p_fragsindex,
-                                                                          i_track_index, p_moof->i_pos );
-                i_traf_start_time = MP4_rescale( i_traf_start_time,
-                                                 p_sys->i_timescale, p_track->i_timescale );
-                b_has_base_media_decode_time = true;
+                stime_t i_index_time;
+                if( MP4_Fragment_Index_GetTrackStartTime( p_sys->p_fragsindex, i_track_index,
+                                                          p_moof->i_pos, &i_index_time ) )
+                {
+                    i_traf_start_time = MP4_rescale( i_index_time,
+                                                     p_sys->i_timescale, p_track->i_timescale );
+                    b_has_base_media_decode_time = true;
+                }
             }
 
             if( !b_has_base_media_decode_time && p_chunksidx )
@@ -5226,6 +5100,7 @@ static int DemuxFrag( demux_t *p_demux )
                         i_status = VLC_DEMUXER_EOF;
                         goto end;
                     }
+                    FragIndexMoof( p_demux, p_sys->context.p_fragment_atom );
 
                     if( b_discontinuity )
                     {
@@ -46,15 +46,12 @@ typedef struct
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-    uint32_t     small_dts_buf[4];
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    uint32_t     *p_sample_offset_pts;  /* pts-dts */
-    uint32_t     small_pts_buf[4];
+    /* position of the first sample in the track stts/ctts run-length
+       tables, which are walked in place rather than copied per chunk */
+    uint32_t     i_dts_entry;   /* stts entry of the first sample */
+    uint32_t     i_dts_skip;    /* samples of that entry in previous chunks */
+    uint32_t     i_pts_entry;   /* ctts entry of the first sample */
+    uint32_t     i_pts_skip;    /* samples of that entry in previous chunks */
 
     /* TODO if needed add pts
         but quickly *add* support for edts and seeking */
@@ -146,8 +143,12 @@ typedef struct
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* stsz table, owned by the box */
+
+    /* sample to time tables, shared by all chunks */
+    const MP4_Box_data_stts_t *p_stts;
+    const MP4_Box_data_ctts_t *p_ctts; /* could be NULL */
+    int64_t          i_cts_shift;
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
@@ -155,7 +156,7 @@ typedef struct
                                                    of the next chunk */
 
     const MP4_Box_t *p_track;
-    const MP4_Box_t *p_stbl;  /* will contain all timing information */
+    MP4_Box_t *p_stbl;  /* will contain all timing information */
     const MP4_Box_t *p_stsd;  /* will contain all data to initialize decoder */
     const MP4_Box_t *p_sample;/* point on actual sdsd */
 
@@ -46,6 +46,7 @@
 #include "ts_hotfixes.h"
 #include "ts_sl.h"
 #include "ts_metadata.h"
+#include "ts_worker.h"
 #include "sections.h"
 #include "pes.h"
 #include "timestamps.h"
@@ -123,6 +124,12 @@ static void Close ( vlc_object_t * );
 #define TS_OFFSETFIX_TEXT   "Try to fix too early PCR (or late DTS)"
 #define TS_GENERATED_PCR_OFFSET_TEXT "Offset in ms for generated PCR"
 
+#define PROGRAM_THREADS_TEXT N_("Output programs from separate threads")
+#define PROGRAM_THREADS_LONGTEXT N_( \
+    "Convert and output the elementary streams of each program from a " \
+    "dedicated thread. This can be useful when demuxing many programs " \
+    "at once, for instance for monitoring a whole multiplex." )
+
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
@@ -163,6 +170,8 @@ vlc_module_begin ()
     add_bool( "ts-pcr-offsetfix", true, TS_OFFSETFIX_TEXT, NULL )
     add_integer_with_range( "ts-generated-pcr-offset", 120, 0, 500,
                             TS_GENERATED_PCR_OFFSET_TEXT, NULL )
+    add_bool( "ts-program-threads", false, PROGRAM_THREADS_TEXT,
+              PROGRAM_THREADS_LONGTEXT )
 
     set_capability( "demux", 10 )
     set_callbacks( Open, Close )
@@ -194,6 +203,13 @@ static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static unsigned PeekTSPackets( demux_t *p_demux, const uint8_t **, unsigned );
+static int ConsumeTSPackets( demux_t *p_demux, unsigned );
+static int SyncTSPackets( demux_t *p_demux, block_t **, unsigned * );
+static uint64_t TSStreamTell( demux_sys_t * );
+static block_t* OwnTSPacket( block_t * );
+static const uint8_t * DescrambleTSPackets( demux_t *p_demux, const uint8_t *, unsigned );
+static const struct vlc_block_callbacks ts_packet_peek_cbs;
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
@@ -503,6 +519,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_lowdelay = var_InheritBool( p_demux, "low-delay" );
     p_sys->b_ignore_time_for_positions = var_InheritBool( p_demux, "ts-seek-percent" );
     p_sys->b_cc_check = var_InheritBool( p_demux, "ts-cc-check" );
+    p_sys->b_program_threads = var_InheritBool( p_demux, "ts-program-threads" );
 
     p_sys->standard = TS_STANDARD_AUTO;
     char *psz_standard = var_InheritString( p_demux, "ts-standard" );
@@ -561,6 +578,7 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    DrainProgramWorkers( p_demux );
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
     vlc_mutex_lock( &p_sys->csa_lock );
@@ -571,6 +589,7 @@ static void Close( vlc_object_t *p_this )
         csa_Delete( p_sys->csa );
     }
     vlc_mutex_unlock( &p_sys->csa_lock );
+    free( p_sys->p_csa_buf );
 
     ARRAY_RESET( p_sys->programs );
 
@@ -633,13 +652,44 @@ static int Demux( demux_t *p_demux )
         p_sys->patfix.status = PAT_FIXTRIED;
     }
 
+    /* Packets are walked in place from the stream buffer, and only copied to
+     * a block when their data is kept */
+    const uint8_t *p_peek = NULL;
+    unsigned i_peeked = 0;
+    block_t peeked_pkt;
+
+    assert( p_sys->i_ts_walked == 0 );
+
     /* We read at most 100 TS packet or until a frame is completed */
     for( unsigned i_pkt = 0; i_pkt < p_sys->i_ts_read; i_pkt++ )
     {
         bool         b_frame = false;
         int          i_header = 0;
         block_t     *p_pkt;
-        if( !(p_pkt = ReadTSPacket( p_demux )) )
+
+        if( p_sys->i_ts_walked == i_peeked )
+        {
+            unsigned i_walked = p_sys->i_ts_walked;
+            p_sys->i_ts_walked = 0;
+            if( i_walked > 0 &&
+                ConsumeTSPackets( p_demux, i_walked ) != VLC_SUCCESS )
+                return VLC_DEMUXER_EOF;
+            i_peeked = PeekTSPackets( p_demux, &p_peek,
+                                      p_sys->i_ts_read - i_pkt );
+            if( i_peeked > 0 && p_sys->csa )
+                p_peek = DescrambleTSPackets( p_demux, p_peek, i_peeked );
+        }
+
+        if( p_sys->i_ts_walked < i_peeked )
+        {
+            p_pkt = block_Init( &peeked_pkt, &ts_packet_peek_cbs,
+                                (uint8_t *) p_peek + p_sys->i_packet_header_size,
+                                p_sys->i_packet_size - p_sys->i_packet_header_size );
+            p_peek += p_sys->i_packet_size;
+            p_sys->i_ts_walked++;
+        }
+        /* Lost synchro or end of stream */
+        else if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
             return VLC_DEMUXER_EOF;
         }
@@ -707,9 +757,20 @@ static int Demux( demux_t *p_demux )
         {
         case TYPE_PAT:
         case TYPE_PMT:
-            /* PAT and PMT are not allowed to be scrambled */
-            ts_psi_Packet_Push( p_pid, p_pkt->p_buffer );
-            block_Release( p_pkt );
+            /* The PMT callback can seek or replace the stream, which
+             * invalidates the walked packets: end the batch first */
+            if( SyncTSPackets( p_demux, &p_pkt, &i_peeked ) != VLC_SUCCESS )
+            {
+                if( p_pkt )
+                    block_Release( p_pkt );
+                return VLC_DEMUXER_EOF;
+            }
+            if( p_pkt )
+            {
+                /* PAT and PMT are not allowed to be scrambled */
+                ts_psi_Packet_Push( p_pid, p_pkt->p_buffer );
+                block_Release( p_pkt );
+            }
             break;
 
         case TYPE_STREAM:
@@ -718,6 +779,7 @@ static int Demux( demux_t *p_demux )
             if( p_sys->es_creation == DELAY_ES ) /* No longer delay ES since that pid's program sends data */
             {
                 msg_Dbg( p_demux, "Creating delayed ES" );
+                DrainProgramWorkers( p_demux );
                 AddAndCreateES( p_demux, p_pid, true );
                 UpdatePESFilters( p_demux, p_sys->seltype == PROGRAM_ALL );
             }
@@ -732,11 +794,13 @@ static int Demux( demux_t *p_demux )
 
             if( p_pid->u.p_stream->transport == TS_TRANSPORT_PES )
             {
-                b_frame = GatherPESData( p_demux, p_pid, p_pkt, i_header );
+                if( (p_pkt = OwnTSPacket( p_pkt )) )
+                    b_frame = GatherPESData( p_demux, p_pid, p_pkt, i_header );
             }
             else if( p_pid->u.p_stream->transport == TS_TRANSPORT_SECTIONS )
             {
-                b_frame = GatherSectionsData( p_demux, p_pid, p_pkt, i_header );
+                if( (p_pkt = OwnTSPacket( p_pkt )) )
+                    b_frame = GatherSectionsData( p_demux, p_pid, p_pkt, i_header );
             }
             else // pid->u.p_pes->transport == TS_TRANSPORT_IGNORE
             {
@@ -768,6 +832,11 @@ static int Demux( demux_t *p_demux )
             break;
     }
 
+    unsigned i_walked = p_sys->i_ts_walked;
+    p_sys->i_ts_walked = 0;
+    if( i_walked > 0 && ConsumeTSPackets( p_demux, i_walked ) != VLC_SUCCESS )
+        return VLC_DEMUXER_EOF;
+
     demux_UpdateTitleFromStream( p_demux );
     return VLC_DEMUXER_SUCCESS;
 }
@@ -814,6 +883,8 @@ void UpdatePESFilters( demux_t *p_demux, bool b_all )
     demux_sys_t *p_sys = p_demux->p_sys;
     ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
 
+    DrainProgramWorkers( p_demux );
+
     /* We need 3 pass to avoid loss on deselect/relesect with hw filters and
        because pid could be shared and its state altered by another unselected pmt
        First clear flag on every referenced pid
@@ -900,6 +971,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     const ts_pmt_t *p_pmt = NULL;
     const ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
 
+    DrainProgramWorkers( p_demux );
+
     for( int i=0; i<p_pat->programs.i_size && !p_pmt; i++ )
     {
         if( p_pat->programs.p_elems[i]->u.p_pmt->b_selected )
@@ -1460,7 +1533,8 @@ static block_t * ConvertPESBlock( demux_t *p_demux, ts_es_t *p_es,
 /****************************************************************************
  * fanouts current block to all subdecoders / shared pid es
  ****************************************************************************/
-static void SendDataChain( demux_t *p_demux, ts_es_t *p_es, block_t *p_chain )
+static void SendDataChain( demux_t *p_demux, ts_es_t *p_es,
+                           int *pi_next_block_flags, block_t *p_chain )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
@@ -1476,13 +1550,14 @@ static void SendDataChain( demux_t *p_demux, ts_es_t *p_es, block_t *p_chain )
         if( p_sys->b_lowdelay )
             p_block->i_flags |= BLOCK_FLAG_AU_END;
 
-        ts_es_t *p_es_send = p_es;
-        if( p_es_send->i_next_block_flags )
+        if( *pi_next_block_flags )
         {
-            p_block->i_flags |= p_es_send->i_next_block_flags;
-            p_es_send->i_next_block_flags = 0;
+            p_block->i_flags |= *pi_next_block_flags;
+            *pi_next_block_flags = 0;
         }
 
+        ts_es_t *p_es_send = p_es;
+
         while( p_es_send )
         {
             if( p_es_send->p_program->b_selected )
@@ -1526,6 +1601,154 @@ static void SendDataChain( demux_t *p_demux, ts_es_t *p_es, block_t *p_chain )
     }
 }
 
+static block_t * ProcessPESBlock( demux_t *p_demux, ts_pid_t *pid,
+                                  size_t i_pes_size, uint8_t i_stream_id,
+                                  block_t *p_block )
+{
+    if( pid->u.p_stream->p_proc )
+    {
+        if( p_block->i_flags & BLOCK_FLAG_DISCONTINUITY )
+            ts_stream_processor_Reset( pid->u.p_stream->p_proc );
+        return ts_stream_processor_Push( pid->u.p_stream->p_proc, i_stream_id, p_block );
+    }
+    /* Some codecs might need xform or AU splitting */
+    return ConvertPESBlock( p_demux, pid->u.p_stream->p_es, i_pes_size, i_stream_id, p_block );
+}
+
+/****************************************************************************
+ * per program output threads
+ ****************************************************************************/
+typedef struct
+{
+    ts_worker_job_t job;
+    demux_t *p_demux;
+    ts_pid_t *pid;
+    block_t *p_block;
+    size_t i_pes_size;
+    uint8_t i_stream_id;
+    bool b_processed;
+    int i_next_block_flags;
+} ts_pes_job_t;
+
+typedef struct
+{
+    ts_worker_job_t job;
+    es_out_t *out;
+    int i_group;
+    vlc_tick_t i_pcr;
+} ts_pcr_job_t;
+
+static void PESJobRun( ts_worker_job_t *p_job )
+{
+    ts_pes_job_t *p_pesjob = container_of( p_job, ts_pes_job_t, job );
+    block_t *p_block = p_pesjob->p_block;
+    if( !p_pesjob->b_processed )
+        p_block = ProcessPESBlock( p_pesjob->p_demux, p_pesjob->pid, p_pesjob->i_pes_size,
+                                   p_pesjob->i_stream_id, p_block );
+    SendDataChain( p_pesjob->p_demux, p_pesjob->pid->u.p_stream->p_es,
+                   &p_pesjob->i_next_block_flags, p_block );
+    free( p_pesjob );
+}
+
+static void PCRJobRun( ts_worker_job_t *p_job )
+{
+    ts_pcr_job_t *p_pcrjob = container_of( p_job, ts_pcr_job_t, job );
+    es_out_Control( p_pcrjob->out, ES_OUT_SET_GROUP_PCR, p_pcrjob->i_group, p_pcrjob->i_pcr );
+    free( p_pcrjob );
+}
+
+static ts_worker_t * GetProgramWorker( demux_t *p_demux, ts_pmt_t *p_pmt )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_pmt->p_worker || !p_sys->b_program_threads )
+        return p_pmt->p_worker;
+
+    p_pmt->p_worker = ts_worker_New( VLC_OBJECT(p_demux) );
+    if( !p_pmt->p_worker )
+    {
+        msg_Warn( p_demux, "cannot create output thread for program %d", p_pmt->i_number );
+        p_sys->b_program_threads = false;
+    }
+    return p_pmt->p_worker;
+}
+
+void DrainProgramWorkers( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    ts_pid_t *patpid = GetPID(p_sys, 0);
+
+    if( patpid->type != TYPE_PAT )
+        return;
+
+    ts_pat_t *p_pat = patpid->u.p_pat;
+    for( int i=0; i< p_pat->programs.i_size; i++ )
+    {
+        ts_pmt_t *p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
+        if( p_pmt->p_worker )
+            ts_worker_Drain( p_pmt->p_worker );
+    }
+}
+
+static void OutputPESBlock( demux_t *p_demux, ts_pid_t *pid,
+                            size_t i_pes_size, uint8_t i_stream_id,
+                            block_t *p_block )
+{
+    ts_es_t *p_es = pid->u.p_stream->p_es;
+    ts_worker_t *p_worker = GetProgramWorker( p_demux, p_es->p_program );
+
+    /* Shared pids are output to other programs too, stay on the demux thread */
+    if( p_worker && p_es->p_next )
+    {
+        DrainProgramWorkers( p_demux );
+        p_worker = NULL;
+    }
+
+    ts_pes_job_t *p_pesjob = p_worker ? malloc( sizeof(*p_pesjob) ) : NULL;
+    if( !p_pesjob )
+    {
+        if( p_worker )
+            ts_worker_Drain( p_worker );
+        p_block = ProcessPESBlock( p_demux, pid, i_pes_size, i_stream_id, p_block );
+        SendDataChain( p_demux, p_es, &p_es->i_next_block_flags, p_block );
+        return;
+    }
+
+    p_pesjob->job.pf_run = PESJobRun;
+    p_pesjob->p_demux = p_demux;
+    p_pesjob->pid = pid;
+    p_pesjob->i_pes_size = i_pes_size;
+    p_pesjob->i_stream_id = i_stream_id;
+    /* Teletext timestamps fixup reads the program clock, do it here */
+    p_pesjob->b_processed = ( p_es->fmt.i_codec == VLC_CODEC_TELETEXT );
+    if( p_pesjob->b_processed )
+        p_block = ProcessPESBlock( p_demux, pid, i_pes_size, i_stream_id, p_block );
+    p_pesjob->p_block = p_block;
+    p_pesjob->i_next_block_flags = p_es->i_next_block_flags;
+    p_es->i_next_block_flags = 0;
+
+    ts_worker_Push( p_worker, &p_pesjob->job );
+}
+
+static void OutputProgramPCR( demux_t *p_demux, ts_pmt_t *p_pmt, vlc_tick_t i_pcr )
+{
+    /* Must not overtake the data already queued for that program */
+    ts_pcr_job_t *p_pcrjob = p_pmt->p_worker ? malloc( sizeof(*p_pcrjob) ) : NULL;
+    if( !p_pcrjob )
+    {
+        if( p_pmt->p_worker )
+            ts_worker_Drain( p_pmt->p_worker );
+        es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, i_pcr );
+        return;
+    }
+
+    p_pcrjob->job.pf_run = PCRJobRun;
+    p_pcrjob->out = p_demux->out;
+    p_pcrjob->i_group = p_pmt->i_number;
+    p_pcrjob->i_pcr = i_pcr;
+    ts_worker_Push( p_pmt->p_worker, &p_pcrjob->job );
+}
+
 /****************************************************************************
  * gathering stuff
  ****************************************************************************/
@@ -1723,20 +1946,7 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes,
                 }
 
                 /*** From here, block can become a chain again though conversion below ***/
-
-                if( pid->u.p_stream->p_proc )
-                {
-                    if( p_block->i_flags & BLOCK_FLAG_DISCONTINUITY )
-                        ts_stream_processor_Reset( pid->u.p_stream->p_proc );
-                    p_block = ts_stream_processor_Push( pid->u.p_stream->p_proc, i_stream_id, p_block );
-                }
-                else
-                /* Some codecs might need xform or AU splitting */
-                {
-                    p_block = ConvertPESBlock( p_demux, p_es, i_pes_size, i_stream_id, p_block );
-                }
-
-                SendDataChain( p_demux, p_es, p_block );
+                OutputPESBlock( p_demux, pid, i_pes_size, i_stream_id, p_block );
             }
             else
             {
@@ -1844,6 +2054,136 @@ static block_t* ReadTSPacket( demux_t *p_demux )
     return p_pkt;
 }
 
+static void PeekedTSPacketRelease( block_t *p_pkt )
+{
+    /* The data belongs to the stream peek buffer */
+    VLC_UNUSED(p_pkt);
+}
+
+static const struct vlc_block_callbacks ts_packet_peek_cbs =
+{
+    PeekedTSPacketRelease,
+};
+
+/* Returns the number of synchronized packets (at most i_max) already
+ * received by the stream, without consuming them. It does not wait for the
+ * whole batch, so that live inputs are not delayed: the caller falls back
+ * to packet reads when less than one packet is available. */
+static unsigned PeekTSPackets( demux_t *p_demux, const uint8_t **pp_peek,
+                               unsigned i_max )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    ssize_t i_peek = vlc_stream_PeekPartial( p_sys->stream, pp_peek,
+                                             (size_t) i_max * p_sys->i_packet_size );
+    if( i_peek < (ssize_t) p_sys->i_packet_size )
+        return 0;
+
+    unsigned i_count = i_peek / p_sys->i_packet_size;
+    const uint8_t *p = *pp_peek + p_sys->i_packet_header_size;
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        /* Re-sync is left to ReadTSPacket() */
+        if( p[i * p_sys->i_packet_size] != 0x47 )
+            return i;
+    }
+    return i_count;
+}
+
+static int ConsumeTSPackets( demux_t *p_demux, unsigned i_count )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    size_t i_size = (size_t) i_count * p_sys->i_packet_size;
+
+    if( vlc_stream_Read( p_sys->stream, NULL, i_size ) != (ssize_t) i_size )
+        return VLC_EGENERIC;
+    return VLC_SUCCESS;
+}
+
+/* Consumes the packets walked so far and ends the batch, turning the
+ * current packet into a copy that stays valid */
+static int SyncTSPackets( demux_t *p_demux, block_t **pp_pkt, unsigned *pi_peeked )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    unsigned i_walked = p_sys->i_ts_walked;
+
+    *pp_pkt = OwnTSPacket( *pp_pkt );
+    p_sys->i_ts_walked = 0;
+    *pi_peeked = 0;
+    if( i_walked > 0 )
+        return ConsumeTSPackets( p_demux, i_walked );
+    return VLC_SUCCESS;
+}
+
+/* Stream position after the current packet, which can be walked ahead of
+ * the stream */
+static uint64_t TSStreamTell( demux_sys_t *p_sys )
+{
+    return vlc_stream_Tell( p_sys->stream ) +
+           (uint64_t) p_sys->i_ts_walked * p_sys->i_packet_size;
+}
+
+/* Descrambles a run of peeked packets all at once, into a copy as the
+ * stream buffer is read only. Returns the packets to walk. */
+static const uint8_t * DescrambleTSPackets( demux_t *p_demux, const uint8_t *p_peek,
+                                            unsigned i_count )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const unsigned i_size = p_sys->i_packet_size;
+    unsigned i_first;
+
+    for( i_first = 0; i_first < i_count; i_first++ )
+    {
+        if( p_peek[i_first * i_size + p_sys->i_packet_header_size + 3] & 0xc0 )
+            break;
+    }
+    if( i_first == i_count )
+        return p_peek;
+
+    if( !p_sys->p_csa_buf )
+    {
+        p_sys->p_csa_buf = malloc( (size_t) p_sys->i_ts_read * i_size );
+        if( !p_sys->p_csa_buf )
+            return p_peek; /* left to ProcessTSPacket() */
+    }
+    memcpy( p_sys->p_csa_buf, p_peek, (size_t) i_count * i_size );
+
+    uint8_t *pp_pkts[CSA_BATCH_SIZE];
+    unsigned i_pkts = 0;
+
+    vlc_mutex_lock( &p_sys->csa_lock );
+    for( unsigned i = i_first; i < i_count; i++ )
+    {
+        uint8_t *p = &p_sys->p_csa_buf[i * i_size + p_sys->i_packet_header_size];
+
+        /* same as ProcessTSPacket(): skip erroneous and null packets */
+        if( (p[3] & 0xc0) == 0 || (p[1] & 0x80) ||
+            ( ( (p[1]&0x1f)<<8 )|p[2] ) == 0x1FFF )
+            continue;
+
+        pp_pkts[i_pkts++] = p;
+        if( i_pkts == CSA_BATCH_SIZE )
+        {
+            csa_DecryptBatch( p_sys->csa, pp_pkts, i_pkts, p_sys->i_csa_pkt_size );
+            i_pkts = 0;
+        }
+    }
+    if( i_pkts > 0 )
+        csa_DecryptBatch( p_sys->csa, pp_pkts, i_pkts, p_sys->i_csa_pkt_size );
+    vlc_mutex_unlock( &p_sys->csa_lock );
+
+    return p_sys->p_csa_buf;
+}
+
+/* Turns a packet walked in place from the stream buffer into a writable
+ * block that can be kept */
+static block_t* OwnTSPacket( block_t *p_pkt )
+{
+    if( p_pkt->cbs != &ts_packet_peek_cbs )
+        return p_pkt;
+    return block_Duplicate( p_pkt );
+}
+
 static stime_t GetPCR( const block_t *p_pkt )
 {
     const uint8_t *p = p_pkt->p_buffer;
@@ -2273,17 +2613,17 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
 
     if ( p_sys->i_pmt_es )
     {
-        es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
+        OutputProgramPCR( p_demux, p_pmt, FROM_SCALE(i_pcr) );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            TSStreamTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TSStreamTell( p_sys );
             }
         }
     }
@@ -2527,6 +2867,10 @@ static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pk
     {
         if( p_sys->csa )
         {
+            /* Descrambling is done in place */
+            if( !(p_pkt = OwnTSPacket( p_pkt )) )
+                return NULL;
+            p = p_pkt->p_buffer;
             vlc_mutex_lock( &p_sys->csa_lock );
             csa_Decrypt( p_sys->csa, p_pkt->p_buffer, p_sys->i_csa_pkt_size );
             vlc_mutex_unlock( &p_sys->csa_lock );
@@ -70,6 +70,8 @@ struct demux_sys_t
 
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
+    /* packets walked in the stream buffer but not consumed yet */
+    unsigned    i_ts_walked;
 
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
@@ -101,8 +103,10 @@ struct demux_sys_t
 
     csa_t       *csa;
     int         i_csa_pkt_size;
+    uint8_t     *p_csa_buf; /* descrambled copy of the walked packets */
     bool        b_split_es;
     bool        b_valid_scrambling;
+    bool        b_program_threads;
 
     bool        b_trust_pcr;
     bool        b_check_pcr_offset;
@@ -156,4 +160,7 @@ int ProbeEnd( demux_t *p_demux, int i_program );
 void AddAndCreateES( demux_t *p_demux, ts_pid_t *pid, bool b_create_delayed );
 int FindPCRCandidate( ts_pmt_t *p_pmt );
 
+/* Waits for the programs workers before changing programs or ES */
+void DrainProgramWorkers( demux_t *p_demux );
+
 #endif
@@ -157,6 +157,8 @@ void SLPackets_Section_Handler( demux_t *p_demux,
         DecodeODCommand( VLC_OBJECT(p_demux), p_ods, i_data - header.i_size, &p_data[header.i_size] );
         bool b_changed = false;
 
+        DrainProgramWorkers( p_demux );
+
         for( int i=0; i<p_ods->objects.i_size; i++ )
         {
             od_descriptor_t *p_od = p_ods->objects.p_elems[i];
@@ -46,6 +46,7 @@
 #include "ts.h"
 
 #include "ts_psip.h"
+#include "ts_worker.h"
 
 static inline bool handle_Init( demux_t *p_demux, dvbpsi_t **handle )
 {
@@ -126,6 +127,7 @@ ts_pmt_t *ts_pmt_New( demux_t *p_demux )
 
     pmt->p_atsc_si_basepid      = NULL;
     pmt->p_si_sdt_pid = NULL;
+    pmt->p_worker = NULL;
 
     pmt->pcr.i_current = TS_TICK_UNKNOWN;
     pmt->pcr.i_first  = TS_TICK_UNKNOWN;
@@ -146,6 +148,9 @@ ts_pmt_t *ts_pmt_New( demux_t *p_demux )
 
 void ts_pmt_Del( demux_t *p_demux, ts_pmt_t *pmt )
 {
+    /* Pending jobs refer to the program streams */
+    if( pmt->p_worker )
+        ts_worker_Delete( pmt->p_worker );
     if( dvbpsi_decoder_present( pmt->handle ) )
         dvbpsi_pmt_detach( pmt->handle );
     dvbpsi_delete( pmt->handle );
@@ -21,6 +21,7 @@
 
 typedef struct dvbpsi_s dvbpsi_t;
 typedef struct ts_sections_processor_t ts_sections_processor_t;
+typedef struct ts_worker_t ts_worker_t;
 
 #include "mpeg4_iod.h"
 #include "timestamps.h"
@@ -56,6 +57,9 @@ struct ts_pmt_t
     /* Used for ref tracking SI pid chain, starting with SDT */
     ts_pid_t        *p_si_sdt_pid;
 
+    /* Converts and outputs ES data and PCR, when enabled */
+    ts_worker_t     *p_worker;
+
     struct
     {
         stime_t i_current;
@@ -0,0 +1,130 @@
+/*****************************************************************************
+ * ts_worker.c: Transport Stream input module for VLC.
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+
+#include "ts_worker.h"
+
+#include <assert.h>
+
+struct ts_worker_t
+{
+    vlc_thread_t thread;
+    vlc_mutex_t  lock;
+    vlc_cond_t   wait; /* for jobs */
+    vlc_cond_t   idle; /* for drain */
+    ts_worker_job_t  *p_first;
+    ts_worker_job_t **pp_last;
+    bool b_running;
+    bool b_closing;
+};
+
+static void * ts_worker_Run( void *data )
+{
+    ts_worker_t *p_worker = data;
+
+    vlc_mutex_lock( &p_worker->lock );
+    for( ;; )
+    {
+        while( !p_worker->p_first && !p_worker->b_closing )
+            vlc_cond_wait( &p_worker->wait, &p_worker->lock );
+
+        ts_worker_job_t *p_job = p_worker->p_first;
+        if( !p_job ) /* closing and no more jobs */
+            break;
+
+        p_worker->p_first = p_job->p_next;
+        if( !p_worker->p_first )
+            p_worker->pp_last = &p_worker->p_first;
+        p_worker->b_running = true;
+        vlc_mutex_unlock( &p_worker->lock );
+
+        p_job->pf_run( p_job );
+
+        vlc_mutex_lock( &p_worker->lock );
+        p_worker->b_running = false;
+        if( !p_worker->p_first )
+            vlc_cond_broadcast( &p_worker->idle );
+    }
+    vlc_mutex_unlock( &p_worker->lock );
+
+    return NULL;
+}
+
+ts_worker_t * ts_worker_New( vlc_object_t *p_obj )
+{
+    ts_worker_t *p_worker = malloc( sizeof(*p_worker) );
+    if( !p_worker )
+        return NULL;
+
+    vlc_mutex_init( &p_worker->lock );
+    vlc_cond_init( &p_worker->wait );
+    vlc_cond_init( &p_worker->idle );
+    p_worker->p_first = NULL;
+    p_worker->pp_last = &p_worker->p_first;
+    p_worker->b_running = false;
+    p_worker->b_closing = false;
+
+    if( vlc_clone( &p_worker->thread, ts_worker_Run, p_worker,
+                   VLC_THREAD_PRIORITY_INPUT ) )
+    {
+        msg_Err( p_obj, "cannot spawn worker thread" );
+        free( p_worker );
+        return NULL;
+    }
+
+    return p_worker;
+}
+
+void ts_worker_Delete( ts_worker_t *p_worker )
+{
+    vlc_mutex_lock( &p_worker->lock );
+    p_worker->b_closing = true;
+    vlc_cond_signal( &p_worker->wait );
+    vlc_mutex_unlock( &p_worker->lock );
+
+    vlc_join( p_worker->thread, NULL );
+    assert( p_worker->p_first == NULL );
+    free( p_worker );
+}
+
+void ts_worker_Push( ts_worker_t *p_worker, ts_worker_job_t *p_job )
+{
+    p_job->p_next = NULL;
+
+    vlc_mutex_lock( &p_worker->lock );
+    assert( !p_worker->b_closing );
+    *p_worker->pp_last = p_job;
+    p_worker->pp_last = &p_job->p_next;
+    vlc_cond_signal( &p_worker->wait );
+    vlc_mutex_unlock( &p_worker->lock );
+}
+
+void ts_worker_Drain( ts_worker_t *p_worker )
+{
+    vlc_mutex_lock( &p_worker->lock );
+    while( p_worker->p_first || p_worker->b_running )
+        vlc_cond_wait( &p_worker->idle, &p_worker->lock );
+    vlc_mutex_unlock( &p_worker->lock );
+}
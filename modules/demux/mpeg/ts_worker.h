@@ -0,0 +1,41 @@
+/*****************************************************************************
+ * ts_worker.h: Transport Stream input module for VLC.
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_WORKER_H
+#define VLC_TS_WORKER_H
+
+/* Runs jobs in submission order on a dedicated thread */
+typedef struct ts_worker_t ts_worker_t;
+typedef struct ts_worker_job_t ts_worker_job_t;
+
+struct ts_worker_job_t
+{
+    ts_worker_job_t *p_next;
+    /* runs then releases the job */
+    void (*pf_run)( ts_worker_job_t * );
+};
+
+ts_worker_t * ts_worker_New( vlc_object_t * );
+/* runs all pending jobs before returning */
+void ts_worker_Delete( ts_worker_t * );
+void ts_worker_Push( ts_worker_t *, ts_worker_job_t * );
+/* waits for all pushed jobs to be run */
+void ts_worker_Drain( ts_worker_t * );
+
+#endif
@@ -146,7 +146,7 @@ void csa_Decrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
     int     i, j, n;
 
     /* transport scrambling control */
-    if( (pkt[3]&0x80) == 0 )
+    if( (pkt[3]&0xc0) == 0 )
     {
         /* not scrambled */
         return;
@@ -607,3 +607,388 @@ static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] )
     }
 }
 
+
+/*****************************************************************************
+ * Batch processing
+ *****************************************************************************
+ * The stream cypher, which costs most, is run bitsliced: bit n of every
+ * word belongs to the n-th packet of the batch, so that all packets are
+ * clocked at once with plain logic operations. The block cypher is kept
+ * per packet.
+ *****************************************************************************/
+typedef uint64_t csa_slice_t;
+
+/* stream blocks for the largest payload, plus the residue */
+#define CSA_STREAM_BLOCKS (184/8+1)
+
+typedef struct
+{
+    csa_slice_t A[11][4];
+    csa_slice_t B[11][4];
+    csa_slice_t X[4], Y[4], Z[4];
+    csa_slice_t D[4], E[4], F[4];
+    csa_slice_t p, q, r;
+} csa_slices_t;
+
+/* Evaluates one output bit of a 5 to 2 bits s-box as a multiplexer tree */
+static inline csa_slice_t csa_SliceSbox( const int sbox[0x20], int bit,
+                                  const csa_slice_t in[5] )
+{
+    csa_slice_t v[16];
+
+    for( int i = 0; i < 16; i++ )
+    {
+        const csa_slice_t lo = -(csa_slice_t)( ( sbox[2*i+0] >> bit )&1 );
+        const csa_slice_t hi = -(csa_slice_t)( ( sbox[2*i+1] >> bit )&1 );
+        v[i] = lo ^ ( ( lo ^ hi ) & in[0] );
+    }
+    for( int k = 1, n = 8; k < 5; k++, n /= 2 )
+    {
+        for( int i = 0; i < n; i++ )
+            v[i] = v[2*i] ^ ( ( v[2*i] ^ v[2*i+1] ) & in[k] );
+    }
+    return v[0];
+}
+
+static void csa_SliceInit( csa_slices_t *s, const uint8_t ck[8] )
+{
+    memset( s, 0, sizeof(*s) );
+
+    for( int i = 0; i < 4; i++ )
+    {
+        for( int b = 0; b < 4; b++ )
+        {
+            s->A[1+2*i+0][b] = -(csa_slice_t)( ( ck[i] >> (4+b) )&1 );
+            s->A[1+2*i+1][b] = -(csa_slice_t)( ( ck[i] >> b )&1 );
+            s->B[1+2*i+0][b] = -(csa_slice_t)( ( ck[4+i] >> (4+b) )&1 );
+            s->B[1+2*i+1][b] = -(csa_slice_t)( ( ck[4+i] >> b )&1 );
+        }
+    }
+}
+
+/* One clock of csa_StreamCypher for all lanes, in_a/in_b being the
+ * initialisation nibbles, or NULL when generating */
+static void csa_SliceClock( csa_slices_t *s,
+                            const csa_slice_t *in_a, const csa_slice_t *in_b,
+                            csa_slice_t *out_hi, csa_slice_t *out_lo )
+{
+    csa_slice_t (*A)[4] = s->A;
+    csa_slice_t (*B)[4] = s->B;
+
+    const csa_slice_t i1[5] = { A[9][0], A[7][3], A[6][1], A[1][2], A[4][0] };
+    const csa_slice_t i2[5] = { A[9][1], A[7][0], A[6][3], A[3][2], A[2][1] };
+    const csa_slice_t i3[5] = { A[6][2], A[5][3], A[5][1], A[2][0], A[1][3] };
+    const csa_slice_t i4[5] = { A[8][0], A[4][2], A[2][3], A[1][1], A[3][3] };
+    const csa_slice_t i5[5] = { A[9][2], A[8][1], A[6][0], A[4][3], A[5][2] };
+    const csa_slice_t i6[5] = { A[9][3], A[7][2], A[5][0], A[4][1], A[3][1] };
+    const csa_slice_t i7[5] = { A[8][3], A[8][2], A[7][1], A[3][0], A[2][2] };
+
+    const csa_slice_t s1[2] = { csa_SliceSbox( sbox1, 0, i1 ), csa_SliceSbox( sbox1, 1, i1 ) };
+    const csa_slice_t s2[2] = { csa_SliceSbox( sbox2, 0, i2 ), csa_SliceSbox( sbox2, 1, i2 ) };
+    const csa_slice_t s3[2] = { csa_SliceSbox( sbox3, 0, i3 ), csa_SliceSbox( sbox3, 1, i3 ) };
+    const csa_slice_t s4[2] = { csa_SliceSbox( sbox4, 0, i4 ), csa_SliceSbox( sbox4, 1, i4 ) };
+    const csa_slice_t s5[2] = { csa_SliceSbox( sbox5, 0, i5 ), csa_SliceSbox( sbox5, 1, i5 ) };
+    const csa_slice_t s6[2] = { csa_SliceSbox( sbox6, 0, i6 ), csa_SliceSbox( sbox6, 1, i6 ) };
+    const csa_slice_t s7[2] = { csa_SliceSbox( sbox7, 0, i7 ), csa_SliceSbox( sbox7, 1, i7 ) };
+
+    /* use 4x4 xor to produce extra nibble for T3 */
+    const csa_slice_t extra_B[4] =
+    {
+        B[9][2] ^ B[6][3] ^ B[3][1] ^ B[8][0],
+        B[5][3] ^ B[8][2] ^ B[4][0] ^ B[5][1],
+        B[6][0] ^ B[8][1] ^ B[3][3] ^ B[4][2],
+        B[3][0] ^ B[6][1] ^ B[7][2] ^ B[9][3],
+    };
+
+    csa_slice_t next_A1[4], next_B1[4], next_E[4];
+    for( int b = 0; b < 4; b++ )
+    {
+        /* T1 */
+        next_A1[b] = A[10][b] ^ s->X[b];
+        if( in_a )
+            next_A1[b] ^= s->D[b] ^ in_a[b];
+
+        /* T2 */
+        next_B1[b] = B[7][b] ^ B[10][b] ^ s->Y[b];
+        if( in_b )
+            next_B1[b] ^= in_b[b];
+    }
+
+    /* if p=1, rotate left */
+    const csa_slice_t b3 = next_B1[3];
+    for( int b = 3; b > 0; b-- )
+        next_B1[b] ^= ( next_B1[b] ^ next_B1[b-1] ) & s->p;
+    next_B1[0] ^= ( next_B1[0] ^ b3 ) & s->p;
+
+    /* T3 */
+    for( int b = 0; b < 4; b++ )
+        s->D[b] = s->E[b] ^ s->Z[b] ^ extra_B[b];
+
+    /* T4 = sum, carry of Z + E + r when q=1 */
+    csa_slice_t carry = s->r;
+    for( int b = 0; b < 4; b++ )
+    {
+        const csa_slice_t sum = s->Z[b] ^ s->E[b] ^ carry;
+        carry = ( s->Z[b] & s->E[b] ) | ( carry & ( s->Z[b] ^ s->E[b] ) );
+        next_E[b] = s->F[b];
+        s->F[b] = s->E[b] ^ ( ( s->E[b] ^ sum ) & s->q );
+    }
+    s->r ^= ( s->r ^ carry ) & s->q;
+    memcpy( s->E, next_E, sizeof(next_E) );
+
+    memmove( &A[2], &A[1], 9 * sizeof(A[0]) );
+    memmove( &B[2], &B[1], 9 * sizeof(B[0]) );
+    memcpy( A[1], next_A1, sizeof(next_A1) );
+    memcpy( B[1], next_B1, sizeof(next_B1) );
+
+    s->X[3] = s4[0]; s->X[2] = s3[0]; s->X[1] = s2[1]; s->X[0] = s1[1];
+    s->Y[3] = s6[0]; s->Y[2] = s5[0]; s->Y[1] = s4[1]; s->Y[0] = s3[1];
+    s->Z[3] = s2[0]; s->Z[2] = s1[0]; s->Z[1] = s6[1]; s->Z[0] = s5[1];
+    s->p = s7[1];
+    s->q = s7[0];
+
+    /* 2 output bits are a function of the 4 bits of D */
+    *out_hi = s->D[2] ^ s->D[3];
+    *out_lo = s->D[0] ^ s->D[1];
+}
+
+/* Runs the stream cypher on i_lanes packets: initialisation with the 8 bytes
+ * at pp_sb[], then generation of i_blocks stream blocks for each packet */
+static void csa_StreamCypherBatch( const uint8_t ck[8], uint8_t *const *pp_sb,
+                                   int i_lanes, int i_blocks,
+                                   uint8_t stream[][CSA_STREAM_BLOCKS*8] )
+{
+    csa_slices_t s;
+    csa_slice_t  sb[8][8] = { { 0 } };
+
+    assert( i_lanes <= CSA_BATCH_SIZE && i_blocks <= CSA_STREAM_BLOCKS );
+
+    for( int l = 0; l < i_lanes; l++ )
+        for( int i = 0; i < 8; i++ )
+            for( int b = 0; b < 8; b++ )
+                sb[i][b] |= (csa_slice_t)( ( pp_sb[l][i] >> b )&1 ) << l;
+
+    csa_SliceInit( &s, ck );
+
+    for( int i = 0; i < 8; i++ )
+    {
+        const csa_slice_t *in1 = &sb[i][4];
+        const csa_slice_t *in2 = &sb[i][0];
+        csa_slice_t hi, lo;
+
+        for( int j = 0; j < 4; j++ )
+            csa_SliceClock( &s, (j % 2) ? in2 : in1, (j % 2) ? in1 : in2,
+                            &hi, &lo );
+    }
+
+    for( int i = 0; i < i_blocks * 8; i++ )
+    {
+        csa_slice_t op[8];
+
+        for( int j = 0; j < 4; j++ )
+            csa_SliceClock( &s, NULL, NULL, &op[7-2*j], &op[6-2*j] );
+
+        for( int l = 0; l < i_lanes; l++ )
+        {
+            uint8_t byte = 0;
+            for( int b = 0; b < 8; b++ )
+                byte |= ( ( op[b] >> l )&1 ) << b;
+            stream[l][i] = byte;
+        }
+    }
+}
+
+static inline int csa_PayloadStart( const uint8_t *pkt )
+{
+    int i_hdr = 4;
+    if( pkt[3]&0x20 )
+    {
+        /* skip adaption field */
+        i_hdr += pkt[4] + 1;
+    }
+    return i_hdr;
+}
+
+static inline int csa_StreamBlocks( int i_pkt_size, int i_hdr )
+{
+    const int n = (i_pkt_size - i_hdr) / 8;
+    const int i_residue = (i_pkt_size - i_hdr) % 8;
+    return __MAX( n - 1, 0 ) + ( i_residue > 0 ? 1 : 0 );
+}
+
+static void csa_DecryptLanes( uint8_t *ck, uint8_t *kk, uint8_t **pp_pkts,
+                              int i_lanes, int i_pkt_size )
+{
+    uint8_t *pp_sb[CSA_BATCH_SIZE];
+    uint8_t  stream[CSA_BATCH_SIZE][CSA_STREAM_BLOCKS*8];
+    int      i_blocks = 0;
+
+    for( int l = 0; l < i_lanes; l++ )
+    {
+        const int i_hdr = csa_PayloadStart( pp_pkts[l] );
+        pp_sb[l] = &pp_pkts[l][i_hdr];
+        i_blocks = __MAX( i_blocks, csa_StreamBlocks( i_pkt_size, i_hdr ) );
+    }
+
+    csa_StreamCypherBatch( ck, pp_sb, i_lanes, i_blocks, stream );
+
+    for( int l = 0; l < i_lanes; l++ )
+    {
+        uint8_t *pkt = pp_pkts[l];
+        const int i_hdr = csa_PayloadStart( pkt );
+        const int n = (i_pkt_size - i_hdr) / 8;
+        const int i_residue = (i_pkt_size - i_hdr) % 8;
+        const uint8_t *p_stream = stream[l];
+        uint8_t ib[8], block[8];
+
+        memcpy( ib, &pkt[i_hdr], 8 );
+        for( int i = 1; i < n + 1; i++ )
+        {
+            csa_BlockDecypher( kk, ib, block );
+            if( i != n )
+            {
+                for( int j = 0; j < 8; j++ )
+                    ib[j] = pkt[i_hdr+8*i+j] ^ p_stream[j];
+                p_stream += 8;
+            }
+            else
+            {
+                /* last block */
+                memset( ib, 0, 8 );
+            }
+            for( int j = 0; j < 8; j++ )
+                pkt[i_hdr+8*(i-1)+j] = ib[j] ^ block[j];
+        }
+
+        for( int j = 0; j < i_residue; j++ )
+            pkt[i_pkt_size - i_residue + j] ^= p_stream[j];
+    }
+}
+
+/*****************************************************************************
+ * csa_DecryptBatch:
+ *****************************************************************************/
+void csa_DecryptBatch( csa_t *c, uint8_t **pp_pkts, int i_count, int i_pkt_size )
+{
+    uint8_t *pp_odd[CSA_BATCH_SIZE], *pp_even[CSA_BATCH_SIZE];
+    int i_odd = 0, i_even = 0;
+
+    for( int i = 0; i < i_count; i++ )
+    {
+        uint8_t *pkt = pp_pkts[i];
+
+        /* transport scrambling control */
+        if( (pkt[3]&0xc0) == 0 )
+            continue;
+        const bool b_odd = pkt[3]&0x40;
+
+        /* clear transport scrambling control */
+        pkt[3] &= 0x3f;
+        if( 188 - csa_PayloadStart( pkt ) < 8 || i_pkt_size - csa_PayloadStart( pkt ) < 0 )
+            continue;
+
+        if( b_odd )
+            pp_odd[i_odd++] = pkt;
+        else
+            pp_even[i_even++] = pkt;
+
+        if( i_odd == CSA_BATCH_SIZE )
+        {
+            csa_DecryptLanes( c->o_ck, c->o_kk, pp_odd, i_odd, i_pkt_size );
+            i_odd = 0;
+        }
+        if( i_even == CSA_BATCH_SIZE )
+        {
+            csa_DecryptLanes( c->e_ck, c->e_kk, pp_even, i_even, i_pkt_size );
+            i_even = 0;
+        }
+    }
+
+    if( i_odd > 0 )
+        csa_DecryptLanes( c->o_ck, c->o_kk, pp_odd, i_odd, i_pkt_size );
+    if( i_even > 0 )
+        csa_DecryptLanes( c->e_ck, c->e_kk, pp_even, i_even, i_pkt_size );
+}
+
+static void csa_EncryptLanes( uint8_t *ck, uint8_t *kk, uint8_t **pp_pkts,
+                              int i_lanes, int i_pkt_size )
+{
+    uint8_t  ib[CSA_BATCH_SIZE][184/8+2][8];
+    uint8_t *pp_sb[CSA_BATCH_SIZE];
+    uint8_t  stream[CSA_BATCH_SIZE][CSA_STREAM_BLOCKS*8];
+    int      i_blocks = 0;
+
+    for( int l = 0; l < i_lanes; l++ )
+    {
+        uint8_t *pkt = pp_pkts[l];
+        const int i_hdr = csa_PayloadStart( pkt );
+        const int n = (i_pkt_size - i_hdr) / 8;
+        uint8_t block[8];
+
+        memset( ib[l][n+1], 0, 8 );
+        for( int i = n; i > 0; i-- )
+        {
+            for( int j = 0; j < 8; j++ )
+                block[j] = pkt[i_hdr+8*(i-1)+j] ^ ib[l][i+1][j];
+            csa_BlockCypher( kk, block, ib[l][i] );
+        }
+        pp_sb[l] = ib[l][1];
+        i_blocks = __MAX( i_blocks, csa_StreamBlocks( i_pkt_size, i_hdr ) );
+    }
+
+    csa_StreamCypherBatch( ck, pp_sb, i_lanes, i_blocks, stream );
+
+    for( int l = 0; l < i_lanes; l++ )
+    {
+        uint8_t *pkt = pp_pkts[l];
+        const int i_hdr = csa_PayloadStart( pkt );
+        const int n = (i_pkt_size - i_hdr) / 8;
+        const int i_residue = (i_pkt_size - i_hdr) % 8;
+        const uint8_t *p_stream = stream[l];
+
+        memcpy( &pkt[i_hdr], ib[l][1], 8 );
+        for( int i = 2; i < n + 1; i++ )
+        {
+            for( int j = 0; j < 8; j++ )
+                pkt[i_hdr+8*(i-1)+j] = ib[l][i][j] ^ p_stream[j];
+            p_stream += 8;
+        }
+        for( int j = 0; j < i_residue; j++ )
+            pkt[i_pkt_size - i_residue + j] ^= p_stream[j];
+    }
+}
+
+/*****************************************************************************
+ * csa_EncryptBatch:
+ *****************************************************************************/
+void csa_EncryptBatch( csa_t *c, uint8_t **pp_pkts, int i_count, int i_pkt_size )
+{
+    uint8_t *ck = c->use_odd ? c->o_ck : c->e_ck;
+    uint8_t *kk = c->use_odd ? c->o_kk : c->e_kk;
+    uint8_t *pp_lanes[CSA_BATCH_SIZE];
+    int i_lanes = 0;
+
+    for( int i = 0; i < i_count; i++ )
+    {
+        uint8_t *pkt = pp_pkts[i];
+
+        /* set transport scrambling control */
+        pkt[3] |= c->use_odd ? 0xc0 : 0x80;
+
+        if( (i_pkt_size - csa_PayloadStart( pkt )) / 8 <= 0 )
+        {
+            pkt[3] &= 0x3f;
+            continue;
+        }
+
+        pp_lanes[i_lanes++] = pkt;
+        if( i_lanes == CSA_BATCH_SIZE )
+        {
+            csa_EncryptLanes( ck, kk, pp_lanes, i_lanes, i_pkt_size );
+            i_lanes = 0;
+        }
+    }
+
+    if( i_lanes > 0 )
+        csa_EncryptLanes( ck, kk, pp_lanes, i_lanes, i_pkt_size );
+}
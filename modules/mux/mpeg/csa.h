@@ -30,6 +30,8 @@ typedef struct csa_t csa_t;
 #define csa_UseKey  __csa_UseKey
 #define csa_Decrypt __csa_decrypt
 #define csa_Encrypt __csa_encrypt
+#define csa_DecryptBatch __csa_decrypt_batch
+#define csa_EncryptBatch __csa_encrypt_batch
 
 csa_t *csa_New( void );
 void   csa_Delete( csa_t * );
@@ -40,4 +42,10 @@ void   csa_UseKey( vlc_object_t *p_caller, csa_t *, bool use_odd );
 void   csa_Decrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
 void   csa_Encrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
 
+/* Same as above for a set of packets of the same size, processed up to
+ * CSA_BATCH_SIZE at once */
+#define CSA_BATCH_SIZE 64
+void   csa_DecryptBatch( csa_t *, uint8_t **pp_pkts, int i_count, int i_pkt_size );
+void   csa_EncryptBatch( csa_t *, uint8_t **pp_pkts, int i_count, int i_pkt_size );
+
 #endif /* _CSA_H */
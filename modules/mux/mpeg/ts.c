@@ -317,6 +317,103 @@ static inline void BufferChainClean( sout_buffer_chain_t *c )
     BufferChainInit( c );
 }
 
+#define TS_BLOCK_PACKETS_MAX 7
+
+/* Transport packets of one muxing pass. Packets are written in place
+ * into output blocks of up to i_block_packets packets each, and only
+ * referenced here for dating, PCR and scrambling. */
+typedef struct
+{
+    uint8_t    *p_buffer;
+    vlc_tick_t  i_dts;
+    vlc_tick_t  i_length;
+    uint32_t    i_flags;
+} ts_packet_t;
+
+typedef struct
+{
+    int          i_depth;
+    int          i_alloc;
+    ts_packet_t *p_packets;
+    int          i_block_packets;
+    block_t     *p_first;
+    block_t    **pp_last;
+    block_t     *p_current; /* block being filled */
+} ts_packets_chain_t;
+
+static inline void TSChainInit( ts_packets_chain_t *c )
+{
+    c->i_depth = 0;
+    c->p_first = NULL;
+    c->pp_last = &c->p_first;
+    c->p_current = NULL;
+}
+
+/* Next packet will start a new output block */
+static inline void TSChainBreak( ts_packets_chain_t *c )
+{
+    c->p_current = NULL;
+}
+
+static ts_packet_t *TSChainNew( ts_packets_chain_t *c )
+{
+    if( c->i_depth == c->i_alloc )
+    {
+        int i_alloc = c->i_alloc ? c->i_alloc * 2 : 256;
+        ts_packet_t *p_packets = realloc( c->p_packets,
+                                          i_alloc * sizeof(*p_packets) );
+        if( !p_packets )
+            return NULL;
+        c->p_packets = p_packets;
+        c->i_alloc = i_alloc;
+    }
+
+    block_t *p_block = c->p_current;
+    if( !p_block || p_block->i_buffer >= (size_t)c->i_block_packets * 188 )
+    {
+        p_block = block_Alloc( c->i_block_packets * 188 );
+        if( !p_block )
+            return NULL;
+        p_block->i_buffer = 0;
+        block_ChainLastAppend( &c->pp_last, p_block );
+        c->p_current = p_block;
+    }
+
+    ts_packet_t *p_ts = &c->p_packets[c->i_depth++];
+    p_ts->p_buffer = &p_block->p_buffer[p_block->i_buffer];
+    p_ts->i_dts = VLC_TICK_INVALID;
+    p_ts->i_length = 0;
+    p_ts->i_flags = 0;
+    p_block->i_buffer += 188;
+    return p_ts;
+}
+
+/* PEStoTS callback for tables */
+static void TSChainAppend( void *opaque, block_t *p_block )
+{
+    ts_packets_chain_t *c = opaque;
+
+    while( p_block )
+    {
+        block_t *p_next = p_block->p_next;
+        ts_packet_t *p_ts = TSChainNew( c );
+        if( p_ts )
+        {
+            memcpy( p_ts->p_buffer, p_block->p_buffer, 188 );
+            p_ts->i_dts = p_block->i_dts;
+            p_ts->i_flags = p_block->i_flags;
+        }
+        block_Release( p_block );
+        p_block = p_next;
+    }
+}
+
+static inline void TSChainClean( ts_packets_chain_t *c )
+{
+    block_ChainRelease( c->p_first );
+    TSChainInit( c );
+}
+
 typedef struct
 {
     sout_buffer_chain_t chain_pes;
@@ -376,6 +473,8 @@ typedef struct
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
     bool            b_crypt_video;
+
+    ts_packets_chain_t chain_ts;
 } sout_mux_sys_t;
 
 
@@ -464,15 +563,21 @@ static int Mux      ( sout_mux_t * );
 
 static block_t *FixPES( sout_mux_t *p_mux, block_fifo_t *p_fifo );
 static block_t *Add_ADTS( block_t *, const es_format_t * );
-static void TSSchedule  ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSSchedule  ( sout_mux_t *p_mux, ts_packets_chain_t *p_chain_ts,
+                          int i_first, int i_packet_count,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
-static void TSDate      ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSDate      ( sout_mux_t *p_mux, ts_packets_chain_t *p_chain_ts,
+                          int i_first, int i_packet_count,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
-static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
-static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
+static void TSWrite     ( sout_mux_t *p_mux, ts_packets_chain_t *p_chain_ts );
+static void TSScramble  ( sout_mux_t *p_mux, uint8_t **pp_pkts, int i_count );
+static void GetPAT( sout_mux_t *p_mux, ts_packets_chain_t *c );
+static void GetPMT( sout_mux_t *p_mux, ts_packets_chain_t *c );
 
-static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts );
+static bool TSStartsKeyFrame( const sout_input_sys_t *p_stream );
+static ts_packet_t *TSNew( sout_mux_t *p_mux, ts_packets_chain_t *c,
+                           sout_input_sys_t *p_stream, bool b_pcr );
+static void TSSetPCR( uint8_t *p_ts, vlc_tick_t i_dts );
 
 static csa_t *csaSetup( vlc_object_t *p_this )
 {
@@ -715,6 +820,11 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
+    /* Output blocks fit in a datagram, leaving room for a RTP header */
+    p_sys->chain_ts.i_block_packets =
+        VLC_CLIP( (var_InheritInteger( p_mux, "mtu" ) - 12) / 188,
+                  1, TS_BLOCK_PACKETS_MAX );
+
     p_mux->p_sys        = p_sys;
 
     p_sys->csa = csaSetup(p_this);
@@ -752,6 +862,7 @@ static void Close( vlc_object_t * p_this )
         free( p_sys->sdt.desc[i].psz_provider );
     }
 
+    free( p_sys->chain_ts.p_packets );
     free( p_sys );
 }
 
@@ -991,16 +1102,11 @@ static void DelStream( sout_mux_t *p_mux, sout_input_t *p_input )
     p_sys->i_pmt_version_number %= 32;
 }
 
-static void SetHeader( sout_buffer_chain_t *c,
+static void SetHeader( ts_packets_chain_t *c,
                         int depth )
 {
-    block_t *p_ts = BufferChainPeek( c );
-    while( depth > 0 )
-    {
-        p_ts = p_ts->p_next;
-        depth--;
-    }
-    p_ts->i_flags |= BLOCK_FLAG_HEADER;
+    if( depth < c->i_depth )
+        c->p_packets[depth].i_flags |= BLOCK_FLAG_HEADER;
 }
 
 static block_t *Pack_Opus(block_t *p_data)
@@ -1151,7 +1257,7 @@ static bool MuxStreams(sout_mux_t *p_mux )
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
     sout_input_sys_t *p_pcr_stream = (sout_input_sys_t*)p_sys->p_pcr_input->p_sys;
 
-    sout_buffer_chain_t chain_ts;
+    ts_packets_chain_t *p_chain_ts = &p_sys->chain_ts;
     vlc_tick_t i_shaping_delay = p_pcr_stream->state.b_key_frame
         ? p_pcr_stream->state.i_pes_length
         : p_sys->i_shaping_delay;
@@ -1440,13 +1546,13 @@ static bool MuxStreams(sout_mux_t *p_mux )
     i_packet_count += (8 * i_pcr_length / p_sys->i_pcr_delay + 175) / 176;
 
     /* 3: mux PES into TS */
-    BufferChainInit( &chain_ts );
+    TSChainInit( p_chain_ts );
     /* append PAT/PMT  -> FIXME with big pcr delay it won't have enough pat/pmt */
     bool pat_was_previous = true; //This is to prevent unnecessary double PAT/PMT insertions
-    GetPAT( p_mux, &chain_ts );
-    GetPMT( p_mux, &chain_ts );
+    GetPAT( p_mux, p_chain_ts );
+    GetPMT( p_mux, p_chain_ts );
     int i_packet_pos = 0;
-    i_packet_count += chain_ts.i_depth;
+    i_packet_count += p_chain_ts->i_depth;
     /* msg_Dbg( p_mux, "estimated pck=%d", i_packet_count ); */
 
     const vlc_tick_t i_pcr_dts = p_pcr_stream->state.i_pes_dts;
@@ -1490,42 +1596,46 @@ static bool MuxStreams(sout_mux_t *p_mux )
             p_sys->i_pcr = i_pcr_dts + packet_length;
         }
 
-        /* Build the TS packet */
-        block_t *p_ts = TSNew( p_mux, p_stream, b_pcr );
-        if( p_sys->csa != NULL &&
-             (p_input->p_fmt->i_cat != AUDIO_ES || p_sys->b_crypt_audio) &&
-             (p_input->p_fmt->i_cat != VIDEO_ES || p_sys->b_crypt_video) )
-        {
-            p_ts->i_flags |= BLOCK_FLAG_SCRAMBLED;
-        }
-        i_packet_pos++;
-
         /* Write PAT/PMT before every keyframe if use-key-frames is enabled,
          * this helps to do segmenting with livehttp-output so it can cut segment
          * and start new one with pat,pmt,keyframe*/
         if( ( p_sys->b_use_key_frames ) &&
             ( p_input->p_fmt->i_cat == VIDEO_ES ) &&
-            ( p_ts->i_flags & BLOCK_FLAG_TYPE_I ) )
+            TSStartsKeyFrame( p_stream ) )
         {
             if( likely( !pat_was_previous ) )
             {
-                int startcount = chain_ts.i_depth;
-                GetPAT( p_mux, &chain_ts );
-                GetPMT( p_mux, &chain_ts );
-                SetHeader( &chain_ts, startcount );
-                i_packet_count += (chain_ts.i_depth - startcount );
+                int startcount = p_chain_ts->i_depth;
+                TSChainBreak( p_chain_ts );
+                GetPAT( p_mux, p_chain_ts );
+                GetPMT( p_mux, p_chain_ts );
+                SetHeader( p_chain_ts, startcount );
+                i_packet_count += (p_chain_ts->i_depth - startcount );
             } else {
-                SetHeader( &chain_ts, 0); //We just inserted pat/pmt,so just flag it instead of adding new one
+                SetHeader( p_chain_ts, 0); //We just inserted pat/pmt,so just flag it instead of adding new one
             }
         }
         pat_was_previous = false;
 
-        /* */
-        BufferChainAppend( &chain_ts, p_ts );
+        /* Build the TS packet */
+        ts_packet_t *p_ts = TSNew( p_mux, p_chain_ts, p_stream, b_pcr );
+        if( unlikely(p_ts == NULL) )
+        {
+            TSChainClean( p_chain_ts );
+            return true;
+        }
+        if( p_sys->csa != NULL &&
+             (p_input->p_fmt->i_cat != AUDIO_ES || p_sys->b_crypt_audio) &&
+             (p_input->p_fmt->i_cat != VIDEO_ES || p_sys->b_crypt_video) )
+        {
+            p_ts->i_flags |= BLOCK_FLAG_SCRAMBLED;
+        }
+        i_packet_pos++;
     }
 
     /* 4: date and send */
-    TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    TSSchedule( p_mux, p_chain_ts, 0, p_chain_ts->i_depth, i_pcr_length, i_pcr_dts );
+    TSWrite( p_mux, p_chain_ts );
     return false;
 }
 
@@ -1660,14 +1770,12 @@ static block_t *Add_ADTS( block_t *p_data, const es_format_t *p_fmt )
     return p_new_block;
 }
 
-static void TSSchedule( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSSchedule( sout_mux_t *p_mux, ts_packets_chain_t *p_chain_ts,
+                        int i_first, int i_packet_count,
                         vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
 {
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
-    sout_buffer_chain_t new_chain;
-    int i_packet_count = p_chain_ts->i_depth;
-
-    BufferChainInit( &new_chain );
+    const ts_packet_t *p_packets = &p_chain_ts->p_packets[i_first];
 
     if ( unlikely(i_pcr_length <= 0) )
     {
@@ -1676,10 +1784,9 @@ static void TSSchedule( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
 
     for (int i = 0; i < i_packet_count; i++ )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
+        const ts_packet_t *p_ts = &p_packets[i];
         vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
-
-        BufferChainAppend( &new_chain, p_ts );
+        int i_cut = i + 1;
 
         if (!p_ts->i_dts || p_ts->i_dts + p_sys->i_dts_delay * 2/3 >= i_new_dts)
             continue;
@@ -1687,37 +1794,36 @@ static void TSSchedule( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
         vlc_tick_t i_max_diff = i_new_dts - p_ts->i_dts;
         vlc_tick_t i_cut_dts = p_ts->i_dts;
 
-        while( (p_ts = BufferChainPeek( p_chain_ts )) )
+        while( i_cut < i_packet_count )
         {
+            p_ts = &p_packets[i_cut];
             i_new_dts = i_pcr_dts + i_pcr_length * i++ / i_packet_count;
             if( p_ts->i_dts >= i_pcr_dts &&
                 i_new_dts - p_ts->i_dts >= i_max_diff )
                break;
-            p_ts = BufferChainGet( p_chain_ts );
-            BufferChainAppend( &new_chain, p_ts );
+            i_cut++;
             i_max_diff = i_new_dts - p_ts->i_dts;
             i_cut_dts = p_ts->i_dts;
         }
         msg_Dbg( p_mux, "adjusting rate at %"PRId64"/%"PRId64" (%d/%d)",
-                 i_cut_dts - i_pcr_dts, i_pcr_length, new_chain.i_depth,
-                 p_chain_ts->i_depth );
-        if ( new_chain.i_depth )
-            TSDate( p_mux, &new_chain, i_cut_dts - i_pcr_dts, i_pcr_dts );
-        if ( p_chain_ts->i_depth )
-            TSSchedule( p_mux, p_chain_ts, i_pcr_dts + i_pcr_length - i_cut_dts,
-                        i_cut_dts );
+                 i_cut_dts - i_pcr_dts, i_pcr_length, i_cut,
+                 i_packet_count - i_cut );
+        TSDate( p_mux, p_chain_ts, i_first, i_cut, i_cut_dts - i_pcr_dts, i_pcr_dts );
+        if ( i_packet_count - i_cut )
+            TSSchedule( p_mux, p_chain_ts, i_first + i_cut, i_packet_count - i_cut,
+                        i_pcr_dts + i_pcr_length - i_cut_dts, i_cut_dts );
         return;
     }
 
-    if ( new_chain.i_depth )
-        TSDate( p_mux, &new_chain, i_pcr_length, i_pcr_dts );
+    if ( i_packet_count )
+        TSDate( p_mux, p_chain_ts, i_first, i_packet_count, i_pcr_length, i_pcr_dts );
 }
 
-static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSDate( sout_mux_t *p_mux, ts_packets_chain_t *p_chain_ts,
+                    int i_first, int i_packet_count,
                     vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
 {
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
-    int i_packet_count = p_chain_ts->i_depth;
 
     if ( unlikely(i_pcr_length / 1000 <= 0) )
     {
@@ -1726,12 +1832,13 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
         i_pcr_length = i_packet_count;
     }
 
+    uint8_t *pp_scrambled[CSA_BATCH_SIZE];
+    int i_scrambled = 0;
+
     /* msg_Dbg( p_mux, "real pck=%d", i_packet_count ); */
-    block_t *p_list = NULL;
-    block_t **pp_last = &p_list;
     for (int i = 0; i < i_packet_count; i++ )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
+        ts_packet_t *p_ts = &p_chain_ts->p_packets[i_first + i];
         vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
 
         p_ts->i_dts    = i_new_dts;
@@ -1740,26 +1847,69 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
         if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
         {
             /* msg_Dbg( p_mux, "pcr=%lld ms", p_ts->i_dts / 1000 ); */
-            TSSetPCR( p_ts, p_ts->i_dts - p_sys->first_dts );
+            TSSetPCR( p_ts->p_buffer, p_ts->i_dts - p_sys->first_dts );
         }
         if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
         {
-            vlc_mutex_lock( &p_sys->csa_lock );
-            csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
-            vlc_mutex_unlock( &p_sys->csa_lock );
+            pp_scrambled[i_scrambled++] = p_ts->p_buffer;
+            if( i_scrambled == CSA_BATCH_SIZE )
+            {
+                TSScramble( p_mux, pp_scrambled, i_scrambled );
+                i_scrambled = 0;
+            }
         }
 
         /* latency */
         p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
+    }
 
-        block_ChainLastAppend( &pp_last, p_ts );
+    if( i_scrambled > 0 )
+        TSScramble( p_mux, pp_scrambled, i_scrambled );
+}
+
+static void TSScramble( sout_mux_t *p_mux, uint8_t **pp_pkts, int i_count )
+{
+    sout_mux_sys_t  *p_sys = p_mux->p_sys;
+
+    vlc_mutex_lock( &p_sys->csa_lock );
+    csa_EncryptBatch( p_sys->csa, pp_pkts, i_count, p_sys->i_csa_pkt_size );
+    vlc_mutex_unlock( &p_sys->csa_lock );
+}
+
+/* Sends the dated packets, one block per group of packets */
+static void TSWrite( sout_mux_t *p_mux, ts_packets_chain_t *p_chain_ts )
+{
+    const ts_packet_t *p_ts = p_chain_ts->p_packets;
+
+    for( block_t *p_block = p_chain_ts->p_first; p_block; p_block = p_block->p_next )
+    {
+        size_t i_count = p_block->i_buffer / 188;
+
+        p_block->i_dts = p_ts->i_dts;
+        p_block->i_length = 0;
+        p_block->i_flags |= p_ts->i_flags & BLOCK_FLAG_HEADER;
+        for( size_t i = 0; i < i_count; i++ )
+            p_block->i_length += p_ts[i].i_length;
+        p_ts += i_count;
     }
-    if ( p_list != NULL )
-        sout_AccessOutWrite( p_mux->p_access, p_list );
+
+    if ( p_chain_ts->p_first != NULL )
+        sout_AccessOutWrite( p_mux->p_access, p_chain_ts->p_first );
+    TSChainInit( p_chain_ts );
+}
+
+/* Whether next TSNew() starts a keyframe */
+static bool TSStartsKeyFrame( const sout_input_sys_t *p_stream )
+{
+    const block_t *p_pes = p_stream->state.chain_pes.p_first;
+
+    return p_stream->state.i_pes_used <= 0 &&
+           !(p_pes->i_flags & BLOCK_FLAG_NO_KEYFRAME) &&
+           (p_pes->i_flags & BLOCK_FLAG_TYPE_I);
 }
 
-static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
-                       bool b_pcr )
+static ts_packet_t *TSNew( sout_mux_t *p_mux, ts_packets_chain_t *c,
+                           sout_input_sys_t *p_stream, bool b_pcr )
 {
     VLC_UNUSED(p_mux);
     block_t *p_pes = p_stream->state.chain_pes.p_first;
@@ -1781,20 +1931,18 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
         b_adaptation_field = true;
     }
 
-    block_t *p_ts = block_Alloc( 188 );
-
-    if (b_new_pes && !(p_pes->i_flags & BLOCK_FLAG_NO_KEYFRAME) && p_pes->i_flags & BLOCK_FLAG_TYPE_I)
-    {
-        p_ts->i_flags |= BLOCK_FLAG_TYPE_I;
-    }
+    ts_packet_t *p_ts = TSChainNew( c );
+    if( unlikely(p_ts == NULL) )
+        return NULL;
+    uint8_t *p_buffer = p_ts->p_buffer;
 
     p_ts->i_dts = p_pes->i_dts;
 
-    p_ts->p_buffer[0] = 0x47;
-    p_ts->p_buffer[1] = ( b_new_pes ? 0x40 : 0x00 ) |
+    p_buffer[0] = 0x47;
+    p_buffer[1] = ( b_new_pes ? 0x40 : 0x00 ) |
         ( ( p_stream->ts.i_pid >> 8 )&0x1f );
-    p_ts->p_buffer[2] = p_stream->ts.i_pid & 0xff;
-    p_ts->p_buffer[3] = ( b_adaptation_field ? 0x30 : 0x10 ) |
+    p_buffer[2] = p_stream->ts.i_pid & 0xff;
+    p_buffer[3] = ( b_adaptation_field ? 0x30 : 0x10 ) |
         p_stream->ts.i_continuity_counter;
 
     p_stream->ts.i_continuity_counter = (p_stream->ts.i_continuity_counter+1)%16;
@@ -1807,30 +1955,29 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
         {
             p_ts->i_flags |= BLOCK_FLAG_CLOCK;
 
-            p_ts->p_buffer[4] = 7 + i_stuffing;
-            p_ts->p_buffer[5] = 1 << 4; /* PCR_flag */
+            p_buffer[4] = 7 + i_stuffing;
+            p_buffer[5] = 1 << 4; /* PCR_flag */
             if( p_stream->ts.b_discontinuity )
             {
-                p_ts->p_buffer[5] |= 0x80; /* flag TS dicontinuity */
+                p_buffer[5] |= 0x80; /* flag TS dicontinuity */
                 p_stream->ts.b_discontinuity = false;
             }
-            memset(&p_ts->p_buffer[12], 0xff, i_stuffing);
+            memset(&p_buffer[12], 0xff, i_stuffing);
         }
         else
         {
-            p_ts->p_buffer[4] = --i_stuffing;
+            p_buffer[4] = --i_stuffing;
             if( i_stuffing-- )
             {
-                p_ts->p_buffer[5] = 0;
-                memset(&p_ts->p_buffer[6], 0xff, i_stuffing);
+                p_buffer[5] = 0;
+                memset(&p_buffer[6], 0xff, i_stuffing);
             }
         }
     }
 
     /* copy payload */
-    memcpy( &p_ts->p_buffer[188 - i_payload],
+    memcpy( &p_buffer[188 - i_payload],
             &p_pes->p_buffer[p_stream->state.i_pes_used], i_payload );
-
     p_stream->state.i_pes_used += i_payload;
     p_stream->state.i_pes_dts = p_pes->i_dts + p_pes->i_length *
         p_stream->state.i_pes_used / p_pes->i_buffer;
@@ -1861,31 +2008,31 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
     return p_ts;
 }
 
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts )
+static void TSSetPCR( uint8_t *p_ts, vlc_tick_t i_dts )
 {
     int64_t i_pcr = TO_SCALE_NZ(i_dts);
 
-    p_ts->p_buffer[6]  = ( i_pcr >> 25 )&0xff;
-    p_ts->p_buffer[7]  = ( i_pcr >> 17 )&0xff;
-    p_ts->p_buffer[8]  = ( i_pcr >> 9  )&0xff;
-    p_ts->p_buffer[9]  = ( i_pcr >> 1  )&0xff;
-    p_ts->p_buffer[10] = ( i_pcr << 7  )&0x80;
-    p_ts->p_buffer[10] |= 0x7e;
-    p_ts->p_buffer[11] = 0; /* we don't set PCR extension */
+    p_ts[6]  = ( i_pcr >> 25 )&0xff;
+    p_ts[7]  = ( i_pcr >> 17 )&0xff;
+    p_ts[8]  = ( i_pcr >> 9  )&0xff;
+    p_ts[9]  = ( i_pcr >> 1  )&0xff;
+    p_ts[10] = ( i_pcr << 7  )&0x80;
+    p_ts[10] |= 0x7e;
+    p_ts[11] = 0; /* we don't set PCR extension */
 }
 
-void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
+void GetPAT( sout_mux_t *p_mux, ts_packets_chain_t *c )
 {
     sout_mux_sys_t       *p_sys = p_mux->p_sys;
 
     BuildPAT( p_sys->p_dvbpsi,
-              c, (PEStoTSCallback)BufferChainAppend,
+              c, TSChainAppend,
               p_sys->i_tsid, p_sys->i_pat_version_number,
               &p_sys->pat,
               p_sys->i_num_pmt, p_sys->pmt, p_sys->i_pmt_program_number );
 }
 
-static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
+static void GetPMT( sout_mux_t *p_mux, ts_packets_chain_t *c )
 {
     sout_mux_sys_t *p_sys = p_mux->p_sys;
     pes_mapped_stream_t mapped[p_mux->i_nb_inputs];
@@ -1907,7 +2054,7 @@ static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
     }
 
     BuildPMT( p_sys->p_dvbpsi, VLC_OBJECT(p_mux), p_sys->standard,
-              c, (PEStoTSCallback)BufferChainAppend,
+              c, TSChainAppend,
               p_sys->i_tsid, p_sys->i_pmt_version_number,
               ((sout_input_sys_t *)p_sys->p_pcr_input->p_sys)->ts.i_pid,
               &p_sys->sdt,
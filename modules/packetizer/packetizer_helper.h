@@ -36,6 +36,11 @@ enum
     STATE_CUSTOM_FIRST,
 };
 
+/* Room reserved in front of large units, so that the small ones preceding
+ * them in an access unit (headers, parameter sets) can be gathered there
+ * without copying the large unit */
+#define PACKETIZER_UNIT_HEADROOM 1024
+
 typedef void (*packetizer_reset_t)( void *p_private, bool b_flush );
 typedef block_t *(*packetizer_parse_t)( void *p_private, bool *pb_ts_used, block_t * );
 typedef block_t *(*packetizer_drain_t)( void *p_private );
@@ -180,7 +185,17 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
             /* Get the new fragment and set the pts/dts */
             block_t *p_block_bytestream = p_pack->bytestream.p_block;
 
-            p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+            const size_t i_pic = p_pack->i_offset + p_pack->i_au_prepend;
+            const size_t i_headroom = i_pic >= 16 * PACKETIZER_UNIT_HEADROOM
+                                    ? PACKETIZER_UNIT_HEADROOM : 0;
+            p_pic = block_Alloc( i_headroom + i_pic );
+            if( unlikely( p_pic == NULL ) )
+            {
+                p_pack->i_state = STATE_NOSYNC;
+                break;
+            }
+            p_pic->p_buffer += i_headroom;
+            p_pic->i_buffer -= i_headroom;
             p_pic->i_pts = p_block_bytestream->i_pts;
             p_pic->i_dts = p_block_bytestream->i_dts;
 
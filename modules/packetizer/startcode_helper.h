@@ -22,6 +22,11 @@
 
 #include <vlc_cpu.h>
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define CAN_COMPILE_STARTCODE_NEON
+#endif
+
 #ifdef CAN_COMPILE_SSE2
 #  if defined __has_attribute
 #    if __has_attribute(__vector_size__)
@@ -65,7 +70,8 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
             return p;
     }
 
-    if( p == end )
+    /* end is the last position a startcode can start at */
+    if( p > end )
         return NULL;
 
     alignedend = end - ((intptr_t) end & 15);
@@ -119,6 +125,80 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
 
 #endif
 
+/* The wide variants below match the whole 00 00 01 sequence for each
+ * position of a vector at once, from 3 loads at consecutive offsets,
+ * which leaves no false positive to check. */
+
+#ifdef CAN_COMPILE_AVX2
+
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindAnnexB_AVX2( const uint8_t *p, const uint8_t *end )
+{
+    for( ; end - p >= 32 + 2; p += 32 )
+    {
+        uint32_t match;
+        asm volatile(
+            "vpxor      %%ymm3,  %%ymm3, %%ymm3\n"
+            "vpcmpeqb   %%ymm4,  %%ymm4, %%ymm4\n"
+            "vpabsb     %%ymm4,  %%ymm4\n"       /* 0x01 */
+            "vpcmpeqb  0(%[v]),  %%ymm3, %%ymm0\n"
+            "vpcmpeqb  1(%[v]),  %%ymm3, %%ymm1\n"
+            "vpcmpeqb  2(%[v]),  %%ymm4, %%ymm2\n"
+            "vpand      %%ymm1,  %%ymm0, %%ymm0\n"
+            "vpand      %%ymm2,  %%ymm0, %%ymm0\n"
+            "vpmovmskb  %%ymm0,  %[match]\n"      /* bit n set for match at p + n */
+            "vzeroupper\n"
+            : [match]"=r"(match)
+            : [v]"r"(p), "m"(*(const uint8_t (*)[32 + 2]) p)
+            : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4"
+        );
+        if( match )
+            return p + vlc_ctz( match );
+    }
+
+    for( end -= 3; p <= end; p++ )
+    {
+        if( p[0] == 0 && p[1] == 0 && p[2] == 1 )
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#ifdef CAN_COMPILE_STARTCODE_NEON
+
+static inline const uint8_t * startcode_FindAnnexB_NEON( const uint8_t *p, const uint8_t *end )
+{
+    const uint8x16_t zeros = vdupq_n_u8( 0 );
+    const uint8x16_t ones = vdupq_n_u8( 1 );
+
+    for( ; end - p >= 16 + 2; p += 16 )
+    {
+        uint8x16_t match = vandq_u8( vandq_u8( vceqq_u8( vld1q_u8( p ), zeros ),
+                                               vceqq_u8( vld1q_u8( p + 1 ), zeros ) ),
+                                     vceqq_u8( vld1q_u8( p + 2 ), ones ) );
+        if( vmaxvq_u8( match ) )
+        {
+            /* narrow to 4 bits per position */
+            uint64_t mask = vget_lane_u64( vreinterpret_u64_u8(
+                                vshrn_n_u16( vreinterpretq_u16_u8( match ), 4 ) ), 0 );
+            return p + vlc_ctzll( mask ) / 4;
+        }
+    }
+
+    for( end -= 3; p <= end; p++ )
+    {
+        if( p[0] == 0 && p[1] == 0 && p[2] == 1 )
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
 /* That code is adapted from libav's ff_avc_find_startcode_internal
  * and i believe the trick originated from
  * https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
@@ -150,14 +230,23 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#ifdef CAN_COMPILE_SSE2
+/* Also matches MPEG-1/2/4 video and VC-1 start codes, which share
+ * the same 00 00 01 prefix */
+#if defined(CAN_COMPILE_SSE2) || defined(CAN_COMPILE_AVX2)
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#  ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return startcode_FindAnnexB_AVX2(p, end);
+#  endif
+#  ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
+#  endif
+    return startcode_FindAnnexB_Bits(p, end);
 }
+#elif defined(CAN_COMPILE_STARTCODE_NEON)
+    #define startcode_FindAnnexB startcode_FindAnnexB_NEON
 #else
     #define startcode_FindAnnexB startcode_FindAnnexB_Bits
 #endif
@@ -1325,40 +1325,148 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 /****************************************************************************
  * RTP send
  ****************************************************************************/
-static void* ThreadSend( void *data )
-{
 #ifdef _WIN32
 # define ENOBUFS      WSAENOBUFS
 # define EAGAIN       WSAEWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
+
+/* Packets sent per system call, if they are due at the same time */
+#ifdef HAVE_SENDMMSG
+# define RTP_SEND_BATCH 32
+#else
+# define RTP_SEND_BATCH 1
+#endif
+
+#ifdef HAVE_SRTP
+static block_t *rtp_protect( sout_stream_id_sys_t *id, block_t *out )
+{
+    /* FIXME: this is awfully inefficient */
+    size_t len = out->i_buffer;
+    out = block_Realloc( out, 0, len + 10 );
+    out->i_buffer = len;
+
+    int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
+    if( val )
+    {
+        msg_Dbg( id->p_stream, "SRTP sending error: %s",
+                 vlc_strerror_c(val) );
+        block_Release( out );
+        return NULL;
+    }
+    out->i_buffer = len;
+    return out;
+}
+#endif
+
+/* Handles a failed send. Returns false if the connection is broken. */
+static bool rtp_sink_error( int fd, const block_t *out )
+{
+    int err = net_errno;
+
+    if( err == EAGAIN || err == ENOBUFS || err == ENOMEM )
+        return true;
+#if (EAGAIN != EWOULDBLOCK)
+    if( err == EWOULDBLOCK )
+        return true;
+#endif
+
+    int type;
+    getsockopt( fd, SOL_SOCKET, SO_TYPE,
+                &type, &(socklen_t){ sizeof(type) });
+    if( type != SOCK_DGRAM )
+        return false;
+
+    /* ICMP soft error: ignore and retry */
+    send( fd, out->p_buffer, out->i_buffer, 0 );
+    return true;
+}
+
+/* Sends packets to one sink. Returns false if the connection is broken. */
+static bool rtp_sink_send( int fd, block_t *const *outv, unsigned outc )
+{
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgs[RTP_SEND_BATCH];
+    struct iovec iov[RTP_SEND_BATCH];
+
+    for( unsigned i = 0; i < outc; i++ )
+    {
+        iov[i].iov_base = outv[i]->p_buffer;
+        iov[i].iov_len = outv[i]->i_buffer;
+        msgs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = &iov[i], .msg_iovlen = 1 };
+        msgs[i].msg_len = 0;
+    }
+
+    for( unsigned i = 0; i < outc; )
+    {
+        int val = sendmmsg( fd, msgs + i, outc - i, 0 );
+        if( val > 0 )
+        {
+            i += val;
+            continue;
+        }
+
+        /* The first unsent packet failed */
+        if( !rtp_sink_error( fd, outv[i] ) )
+            return false;
+        i++;
+    }
+#else
+    for( unsigned i = 0; i < outc; i++ )
+        if( send( fd, outv[i]->p_buffer, outv[i]->i_buffer, 0 ) == -1
+         && !rtp_sink_error( fd, outv[i] ) )
+            return false;
+#endif
+    return true;
+}
+
+static void* ThreadSend( void *data )
+{
     sout_stream_id_sys_t *id = data;
     vlc_tick_t i_caching = id->i_caching;
-    block_t *out;
+    block_t *outv[RTP_SEND_BATCH];
+    block_t *next = NULL; /* dequeued, but not due yet */
 
-    while ((out = vlc_queue_DequeueKillable(&id->queue, &id->dead)) != NULL)
+    for( ;; )
     {
+        block_t *out = next;
+
+        next = NULL;
+        if( out == NULL )
+            out = vlc_queue_DequeueKillable(&id->queue, &id->dead);
+        if( out == NULL )
+            break;
+
 #ifdef HAVE_SRTP
-        if( id->srtp )
-        {   /* FIXME: this is awfully inefficient */
-            size_t len = out->i_buffer;
-            out = block_Realloc( out, 0, len + 10 );
-            out->i_buffer = len;
-
-            int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
-            if( val )
-            {
-                msg_Dbg( id->p_stream, "SRTP sending error: %s",
-                         vlc_strerror_c(val) );
-                block_Release( out );
-                continue;
-            }
-            out->i_buffer = len;
-        }
+        if( id->srtp && (out = rtp_protect( id, out )) == NULL )
+            continue;
 #endif
         vlc_tick_wait (out->i_dts + i_caching);
 
-        ssize_t len = out->i_buffer;
+        /* Gather the queued packets due by now, to send them at once */
+        vlc_tick_t now = vlc_tick_now();
+        unsigned outc = 0;
+
+        outv[outc++] = out;
+        while( outc < RTP_SEND_BATCH )
+        {
+            vlc_queue_Lock( &id->queue );
+            out = vlc_queue_DequeueUnlocked( &id->queue );
+            vlc_queue_Unlock( &id->queue );
+            if( out == NULL )
+                break;
+            if( out->i_dts + i_caching > now )
+            {
+                next = out;
+                break;
+            }
+#ifdef HAVE_SRTP
+            if( id->srtp && (out = rtp_protect( id, out )) == NULL )
+                continue;
+#endif
+            outv[outc++] = out;
+        }
 
         vlc_mutex_lock( &id->lock_sink );
         unsigned deadc = 0; /* How many dead sockets? */
@@ -1369,26 +1477,18 @@ static void* ThreadSend( void *data )
 #ifdef HAVE_SRTP
             if( !id->srtp ) /* FIXME: SRTCP support */
 #endif
-                SendRTCP( id->sinkv[i].rtcp, out );
+                for( unsigned j = 0; j < outc; j++ )
+                    SendRTCP( id->sinkv[i].rtcp, outv[j] );
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
-            {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
-            }
+            if( !rtp_sink_send( id->sinkv[i].rtp_fd, outv, outc ) )
+                /* Broken connection */
+                deadv[deadc++] = id->sinkv[i].rtp_fd;
         }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
+        id->i_seq_sent_next =
+            ntohs(((uint16_t *) outv[outc - 1]->p_buffer)[1]) + 1;
         vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
+        for( unsigned j = 0; j < outc; j++ )
+            block_Release( outv[j] );
 
         for( unsigned i = 0; i < deadc; i++ )
         {
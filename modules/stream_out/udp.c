@@ -145,39 +145,78 @@ static int Control(sout_stream_t *stream, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+/* Datagrams sent per system call */
+#ifdef HAVE_SENDMMSG
+# define VLEN 32
+#else
+# define VLEN 1
+#endif
+
 static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
 {
     struct sout_stream_udp *sys = access->p_sys;
     ssize_t total = 0;
 
     while (block != NULL) {
-        struct iovec iov[16];
+        struct iovec iov[VLEN][16];
+#ifdef HAVE_SENDMMSG
+        struct mmsghdr msgs[VLEN];
+#endif
+        struct msghdr hdrs[VLEN];
         block_t *unsent = block;
-        unsigned iovlen = 0;
-        size_t tosend = 0;
+        unsigned count = 0;
 
-        /* Count how many blocks to gather */
         do {
-            if (iovlen >= ARRAY_SIZE(iov))
-                break;
-            if (unsent->i_buffer + tosend > sys->mtu && likely(iovlen > 0))
-                break;
-
-            iov[iovlen].iov_base = unsent->p_buffer;
-            iov[iovlen].iov_len = unsent->i_buffer;
-            iovlen++;
-            tosend += unsent->i_buffer;
-            unsent = unsent->p_next;
-        } while (unsent != NULL);
+            unsigned iovlen = 0;
+            size_t tosend = 0;
+
+            /* Count how many blocks to gather */
+            do {
+                if (iovlen >= ARRAY_SIZE(iov[0]))
+                    break;
+                if (unsent->i_buffer + tosend > sys->mtu && likely(iovlen > 0))
+                    break;
+
+                iov[count][iovlen].iov_base = unsent->p_buffer;
+                iov[count][iovlen].iov_len = unsent->i_buffer;
+                iovlen++;
+                tosend += unsent->i_buffer;
+                unsent = unsent->p_next;
+            } while (unsent != NULL);
+
+            hdrs[count] = (struct msghdr) {
+                .msg_iov = iov[count], .msg_iovlen = iovlen };
+            count++;
+        } while (unsent != NULL && count < VLEN);
 
         /* Send */
-        struct msghdr hdr = { .msg_iov = iov, .msg_iovlen = iovlen };
-        int val = sendmsg(sys->fd, &hdr, 0);
+#ifdef HAVE_SENDMMSG
+        for (unsigned i = 0; i < count; i++) {
+            msgs[i].msg_hdr = hdrs[i];
+            msgs[i].msg_len = 0;
+        }
+
+        for (unsigned sent = 0; sent < count;) {
+            int val = sendmmsg(sys->fd, msgs + sent, count - sent, 0);
+
+            if (val < 0) {
+                msg_Err(access, "send error: %s", vlc_strerror_c(errno));
+                sent++; /* drop the failing datagram */
+                continue;
+            }
+
+            for (int i = 0; i < val; i++)
+                total += msgs[sent + i].msg_len;
+            sent += val;
+        }
+#else
+        int val = sendmsg(sys->fd, &hdrs[0], 0);
 
         if (val < 0)
             msg_Err(access, "send error: %s", vlc_strerror_c(errno));
         else
             total += val;
+#endif
 
         /* Free */
         do {
@@ -182,6 +182,9 @@ struct vlc_input_decoder_t
  * a bogus PTS and won't be displayed */
 #define DECODER_BOGUS_VIDEO_DELAY                ((vlc_tick_t)(DEFAULT_PTS_DELAY * 30))
 
+/* Number of queued frames above which a paced input waits for the decoder */
+#define DECODER_FIFO_PACING_COUNT 10
+
 /* */
 #define DECODER_SPU_VOUT_WAIT_DURATION   VLC_TICK_FROM_MS(200)
 #define BLOCK_FLAG_CORE_PRIVATE_RELOADED (1 << BLOCK_FLAG_CORE_PRIVATE_SHIFT)
@@ -1715,7 +1718,9 @@ static void *DecoderThread( void *p_data )
             continue;
         }
 
-        vlc_cond_signal( &p_owner->wait_fifo );
+        /* Only a full FIFO can block a pacing vlc_input_decoder_Decode() */
+        if( vlc_fifo_GetCount( p_owner->p_fifo ) >= DECODER_FIFO_PACING_COUNT )
+            vlc_cond_signal( &p_owner->wait_fifo );
 
         vlc_frame_t *frame = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
         if( frame == NULL )
@@ -2254,7 +2259,7 @@ void vlc_input_decoder_Decode( vlc_input_decoder_t *p_owner, vlc_frame_t *frame,
     {   /* The FIFO is not consumed when waiting, so pacing would deadlock VLC.
          * Locking is not necessary as b_waiting is only read, not written by
          * the decoder thread. */
-        while( vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
+        while( vlc_fifo_GetCount( p_owner->p_fifo ) >= DECODER_FIFO_PACING_COUNT )
             vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
     }
 
@@ -2321,6 +2326,7 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
 
     /* Empty the fifo */
     block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    vlc_cond_signal( &p_owner->wait_fifo );
 
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
@@ -510,7 +510,7 @@ ssize_t vlc_stream_Read(stream_t *s, void *buf, size_t len)
     return copied;
 }
 
-ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
+static block_t *vlc_stream_PeekBuffer(stream_t *s, size_t len)
 {
     stream_priv_t *priv = (stream_priv_t *)s;
     block_t *peek;
@@ -527,7 +527,7 @@ ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
     {
         peek = block_Alloc(len);
         if (unlikely(peek == NULL))
-            return VLC_ENOMEM;
+            return NULL;
 
         peek->i_buffer = 0;
     }
@@ -538,12 +538,21 @@ ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
 
         peek = block_TryRealloc(peek, 0, len);
         if (unlikely(peek == NULL))
-            return VLC_ENOMEM;
+            return NULL;
 
         peek->i_buffer = avail;
     }
 
     priv->peek = peek;
+    return peek;
+}
+
+ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
+{
+    block_t *peek = vlc_stream_PeekBuffer(s, len);
+    if (unlikely(peek == NULL))
+        return VLC_ENOMEM;
+
     *bufp = peek->p_buffer;
 
     while (peek->i_buffer < len)
@@ -564,6 +573,38 @@ ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
     return len;
 }
 
+ssize_t vlc_stream_PeekPartial(stream_t *s, const uint8_t **restrict bufp,
+                               size_t len)
+{
+    stream_priv_t *priv = (stream_priv_t *)s;
+    block_t *peek = vlc_stream_PeekBuffer(s, len);
+    if (unlikely(peek == NULL))
+        return VLC_ENOMEM;
+
+    *bufp = peek->p_buffer;
+
+    while (peek->i_buffer < len)
+    {
+        size_t avail = peek->i_buffer;
+        ssize_t ret;
+
+        /* Once some data is available, only take what is already queued */
+        if (avail > 0 && priv->block == NULL)
+            break;
+
+        ret = vlc_stream_ReadRaw(s, peek->p_buffer + avail, len - avail);
+        if (ret < 0)
+            continue;
+
+        peek->i_buffer += ret;
+
+        if (ret == 0)
+            break;
+    }
+
+    return (peek->i_buffer < len) ? peek->i_buffer : len;
+}
+
 block_t *vlc_stream_ReadBlock(stream_t *s)
 {
     stream_priv_t *priv = (stream_priv_t *)s;
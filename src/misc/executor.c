@@ -24,28 +24,49 @@
 
 #include <vlc_executor.h>
 
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
 #include <vlc_atomic.h>
 #include <vlc_list.h>
 #include <vlc_threads.h>
 #include "libvlc.h"
 
+/**
+ * A queue of pending runnables, of a single priority class.
+ *
+ * Each thread owns one queue per priority class. Runnables submitted from an
+ * executor thread are queued to that thread's own queue; runnables submitted
+ * from elsewhere are distributed among the threads. A thread with no runnable
+ * left in its own queues steals runnables from the queues of other threads.
+ */
+struct vlc_executor_queue {
+    vlc_mutex_t lock;
+
+    /** List of vlc_runnable */
+    struct vlc_list runnables;
+
+    /** Number of runnables (readable without the lock to skip empty queues) */
+    atomic_uint count;
+
+    enum vlc_executor_priority priority;
+};
+
 /**
  * An executor can spawn several threads.
  *
  * This structure contains the data specific to one thread.
  */
 struct vlc_executor_thread {
-    /** Node of vlc_executor.threads list */
-    struct vlc_list node;
-
     /** The executor owning the thread */
     vlc_executor_t *owner;
 
     /** The system thread */
     vlc_thread_t thread;
 
-    /** The current task executed by the thread, NULL if none */
-    struct vlc_runnable *current_task;
+    /** Pending runnables submitted to this thread, by priority */
+    struct vlc_executor_queue queues[VLC_EXECUTOR_PRIORITY_COUNT];
 };
 
 /**
@@ -53,118 +74,189 @@ struct vlc_executor_thread {
  * header).
  */
 struct vlc_executor {
+    /** Only used to spawn threads, and to wait for runnables or idleness */
     vlc_mutex_t lock;
 
     /** Maximum number of threads to run the tasks */
     unsigned max_threads;
 
-    /** List of active vlc_executor_thread */
-    struct vlc_list threads;
+    /** Thread count (threads[0] to threads[nthreads - 1] are running) */
+    atomic_uint nthreads;
 
-    /** Thread count (in a separate field to quickly compare to max_threads) */
-    unsigned nthreads;
+    /** Index of the thread to queue the next external submission to */
+    atomic_uint next_thread;
 
     /* Number of tasks requested but not finished. */
-    unsigned unfinished;
+    atomic_uint unfinished;
 
     /** Wait for the executor to be idle (i.e. unfinished == 0) */
     vlc_cond_t idle_wait;
 
-    /** Queue of vlc_runnable */
-    struct vlc_list queue;
+    /** Number of tasks requested but not started nor canceled */
+    atomic_uint pending;
+
+    /** Number of threads waiting on queue_wait */
+    atomic_uint sleepers;
 
-    /** Wait for the queue to be non-empty */
+    /** Wait for a task to be pending */
     vlc_cond_t queue_wait;
 
     /** True if executor deletion is requested */
     bool closing;
+
+    /** Thread slots (max_threads) */
+    struct vlc_executor_thread threads[];
 };
 
+/** The executor thread running on the current thread, if any */
+static thread_local struct vlc_executor_thread *current_thread;
+
 static void
-QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable)
+QueueInit(struct vlc_executor_queue *queue, enum vlc_executor_priority priority)
 {
-    vlc_mutex_assert(&executor->lock);
+    vlc_mutex_init(&queue->lock);
+    vlc_list_init(&queue->runnables);
+    atomic_init(&queue->count, 0);
+    queue->priority = priority;
+}
 
-    vlc_list_append(&runnable->node, &executor->queue);
-    vlc_cond_signal(&executor->queue_wait);
+static void
+QueuePush(struct vlc_executor_queue *queue, struct vlc_runnable *runnable)
+{
+    vlc_mutex_lock(&queue->lock);
+    runnable->queue = queue;
+    vlc_list_append(&runnable->node, &queue->runnables);
+    atomic_fetch_add_explicit(&queue->count, 1, memory_order_relaxed);
+    vlc_mutex_unlock(&queue->lock);
 }
 
 static struct vlc_runnable *
-QueueTake(vlc_executor_t *executor)
+QueueTake(vlc_executor_t *executor, struct vlc_executor_queue *queue)
 {
-    vlc_mutex_assert(&executor->lock);
-
-    while (!executor->closing && vlc_list_is_empty(&executor->queue))
-        vlc_cond_wait(&executor->queue_wait, &executor->lock);
-
-    if (executor->closing)
+    if (atomic_load_explicit(&queue->count, memory_order_relaxed) == 0)
         return NULL;
 
+    vlc_mutex_lock(&queue->lock);
+
     struct vlc_runnable *runnable =
-        vlc_list_first_entry_or_null(&executor->queue, struct vlc_runnable,
+        vlc_list_first_entry_or_null(&queue->runnables, struct vlc_runnable,
                                      node);
-    assert(runnable);
-    vlc_list_remove(&runnable->node);
+    if (runnable)
+    {
+        vlc_list_remove(&runnable->node);
+        atomic_fetch_sub_explicit(&queue->count, 1, memory_order_relaxed);
+        atomic_fetch_sub(&executor->pending, 1);
 
-    /* Set links to NULL to know that it has been taken by a thread in
-     * vlc_executor_Cancel() */
-    runnable->node.prev = runnable->node.next = NULL;
+        /* Set links to NULL to know that it has been taken by a thread in
+         * vlc_executor_Cancel() */
+        runnable->node.prev = runnable->node.next = NULL;
+    }
+
+    vlc_mutex_unlock(&queue->lock);
 
     return runnable;
 }
 
+static struct vlc_runnable *
+TakeRunnable(struct vlc_executor_thread *thread)
+{
+    vlc_executor_t *executor = thread->owner;
+    unsigned self = thread - executor->threads;
+
+    for (unsigned p = 0; p < VLC_EXECUTOR_PRIORITY_COUNT; ++p)
+    {
+        /* Own queue first */
+        struct vlc_runnable *runnable = QueueTake(executor, &thread->queues[p]);
+        if (runnable)
+            return runnable;
+
+        /* Then steal from the other threads, starting from the next one to
+         * spread the thieves over the victims */
+        unsigned nthreads = atomic_load_explicit(&executor->nthreads,
+                                                 memory_order_acquire);
+        for (unsigned i = 1; i < nthreads; ++i)
+        {
+            struct vlc_executor_thread *victim =
+                &executor->threads[(self + i) % nthreads];
+
+            runnable = QueueTake(executor, &victim->queues[p]);
+            if (runnable)
+                return runnable;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+SignalFinished(vlc_executor_t *executor)
+{
+    unsigned unfinished = atomic_fetch_sub(&executor->unfinished, 1);
+    assert(unfinished > 0);
+    if (unfinished == 1)
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_broadcast(&executor->idle_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
 static void *
 ThreadRun(void *userdata)
 {
     struct vlc_executor_thread *thread = userdata;
     vlc_executor_t *executor = thread->owner;
 
-    vlc_mutex_lock(&executor->lock);
+    current_thread = thread;
 
-    struct vlc_runnable *runnable;
-    /* When the executor is closing, QueueTake() returns NULL */
-    while ((runnable = QueueTake(executor)))
+    for (;;)
     {
-        thread->current_task = runnable;
-        vlc_mutex_unlock(&executor->lock);
-
-        /* Execute the user-provided runnable, without the executor lock */
+        struct vlc_runnable *runnable = TakeRunnable(thread);
+        if (!runnable)
+        {
+            vlc_mutex_lock(&executor->lock);
+            /* Sequentially consistent with the pending count increment in
+             * Submit(): either we see the new task, or the submitter sees
+             * this thread sleeping and signals it */
+            atomic_fetch_add(&executor->sleepers, 1);
+            while (!executor->closing && atomic_load(&executor->pending) == 0)
+                vlc_cond_wait(&executor->queue_wait, &executor->lock);
+            atomic_fetch_sub(&executor->sleepers, 1);
+
+            bool closing = executor->closing;
+            vlc_mutex_unlock(&executor->lock);
+
+            if (closing)
+                break;
+            continue;
+        }
+
+        /* Execute the user-provided runnable, without any executor lock */
         runnable->run(runnable->userdata);
 
-        vlc_mutex_lock(&executor->lock);
-        thread->current_task = NULL;
-
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
+        SignalFinished(executor);
     }
 
-    vlc_mutex_unlock(&executor->lock);
-
     return NULL;
 }
 
 static int
 SpawnThread(vlc_executor_t *executor)
 {
-    assert(executor->nthreads < executor->max_threads);
+    vlc_mutex_assert(&executor->lock);
 
-    struct vlc_executor_thread *thread = malloc(sizeof(*thread));
-    if (!thread)
-        return VLC_ENOMEM;
+    unsigned nthreads = atomic_load_explicit(&executor->nthreads,
+                                             memory_order_relaxed);
+    assert(nthreads < executor->max_threads);
 
-    thread->owner = executor;
-    thread->current_task = NULL;
+    struct vlc_executor_thread *thread = &executor->threads[nthreads];
 
     if (vlc_clone(&thread->thread, ThreadRun, thread, VLC_THREAD_PRIORITY_LOW))
-    {
-        free(thread);
         return VLC_EGENERIC;
-    }
 
-    executor->nthreads++;
-    vlc_list_append(&thread->node, &executor->threads);
+    /* Publish the thread (and its queues) to submitters and thieves */
+    atomic_store_explicit(&executor->nthreads, nthreads + 1,
+                          memory_order_release);
 
     return VLC_SUCCESS;
 }
@@ -173,26 +265,37 @@ vlc_executor_t *
 vlc_executor_New(unsigned max_threads)
 {
     assert(max_threads);
-    vlc_executor_t *executor = malloc(sizeof(*executor));
+    vlc_executor_t *executor =
+        malloc(sizeof(*executor) + max_threads * sizeof(*executor->threads));
     if (!executor)
         return NULL;
 
     vlc_mutex_init(&executor->lock);
 
     executor->max_threads = max_threads;
-    executor->nthreads = 0;
-    executor->unfinished = 0;
-
-    vlc_list_init(&executor->threads);
-    vlc_list_init(&executor->queue);
+    atomic_init(&executor->nthreads, 0);
+    atomic_init(&executor->next_thread, 0);
+    atomic_init(&executor->unfinished, 0);
+    atomic_init(&executor->pending, 0);
+    atomic_init(&executor->sleepers, 0);
 
     vlc_cond_init(&executor->idle_wait);
     vlc_cond_init(&executor->queue_wait);
 
     executor->closing = false;
 
+    for (unsigned i = 0; i < max_threads; ++i)
+    {
+        struct vlc_executor_thread *thread = &executor->threads[i];
+        thread->owner = executor;
+        for (unsigned p = 0; p < VLC_EXECUTOR_PRIORITY_COUNT; ++p)
+            QueueInit(&thread->queues[p], p);
+    }
+
     /* Create one thread on init so that vlc_executor_Submit() may never fail */
+    vlc_mutex_lock(&executor->lock);
     int ret = SpawnThread(executor);
+    vlc_mutex_unlock(&executor->lock);
     if (ret != VLC_SUCCESS)
     {
         free(executor);
@@ -203,26 +306,65 @@ vlc_executor_New(unsigned max_threads)
 }
 
 void
-vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+vlc_executor_SubmitPriority(vlc_executor_t *executor,
+                            struct vlc_runnable *runnable,
+                            enum vlc_executor_priority priority)
 {
-    vlc_mutex_lock(&executor->lock);
-
+    assert(priority < VLC_EXECUTOR_PRIORITY_COUNT);
     assert(!executor->closing);
 
-    QueuePush(executor, runnable);
+    unsigned unfinished = atomic_fetch_add(&executor->unfinished, 1) + 1;
+    unsigned nthreads = atomic_load_explicit(&executor->nthreads,
+                                             memory_order_acquire);
 
-    if (++executor->unfinished > executor->nthreads
-            && executor->nthreads < executor->max_threads)
-        /* If it fails, this is not an error, there is at least one thread */
-        SpawnThread(executor);
+    if (unfinished > nthreads && nthreads < executor->max_threads)
+    {
+        vlc_mutex_lock(&executor->lock);
+        nthreads = atomic_load_explicit(&executor->nthreads,
+                                        memory_order_relaxed);
+        if (unfinished > nthreads && nthreads < executor->max_threads
+         && SpawnThread(executor) == VLC_SUCCESS)
+            /* If it fails, this is not an error, there is at least one
+             * thread */
+            nthreads++;
+        vlc_mutex_unlock(&executor->lock);
+    }
 
-    vlc_mutex_unlock(&executor->lock);
+    /* Keep the tasks spawned by a task local to its thread, distribute the
+     * other ones */
+    struct vlc_executor_thread *thread = current_thread;
+    if (thread == NULL || thread->owner != executor)
+    {
+        unsigned index = atomic_fetch_add_explicit(&executor->next_thread, 1,
+                                                   memory_order_relaxed);
+        thread = &executor->threads[index % nthreads];
+    }
+
+    QueuePush(&thread->queues[priority], runnable);
+
+    atomic_fetch_add(&executor->pending, 1);
+    if (atomic_load(&executor->sleepers) > 0)
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_signal(&executor->queue_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
+void
+vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+{
+    vlc_executor_SubmitPriority(executor, runnable,
+                                VLC_EXECUTOR_PRIORITY_NORMAL);
 }
 
 bool
 vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
 {
-    vlc_mutex_lock(&executor->lock);
+    /* The queue of a runnable never changes once submitted */
+    struct vlc_executor_queue *queue = runnable->queue;
+
+    vlc_mutex_lock(&queue->lock);
 
     /* Either both prev and next are set, either both are NULL */
     assert(!runnable->node.prev == !runnable->node.next);
@@ -231,14 +373,14 @@ vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
     if (in_queue)
     {
         vlc_list_remove(&runnable->node);
-
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
+        atomic_fetch_sub_explicit(&queue->count, 1, memory_order_relaxed);
+        atomic_fetch_sub(&executor->pending, 1);
     }
 
-    vlc_mutex_unlock(&executor->lock);
+    vlc_mutex_unlock(&queue->lock);
+
+    if (in_queue)
+        SignalFinished(executor);
 
     return in_queue;
 }
@@ -247,7 +389,7 @@ void
 vlc_executor_WaitIdle(vlc_executor_t *executor)
 {
     vlc_mutex_lock(&executor->lock);
-    while (executor->unfinished)
+    while (atomic_load(&executor->unfinished))
         vlc_cond_wait(&executor->idle_wait, &executor->lock);
     vlc_mutex_unlock(&executor->lock);
 }
@@ -260,29 +402,26 @@ vlc_executor_Delete(vlc_executor_t *executor)
     executor->closing = true;
 
     /* All the tasks must be canceled on delete */
-    assert(vlc_list_is_empty(&executor->queue));
-
-    vlc_mutex_unlock(&executor->lock);
+    assert(atomic_load(&executor->pending) == 0);
 
     /* "closing" is now true, this will wake up threads */
     vlc_cond_broadcast(&executor->queue_wait);
 
-    /* The threads list may not be written at this point, so it is safe to read
-     * it without mutex locked (the mutex must be released to join the
-     * threads). */
+    vlc_mutex_unlock(&executor->lock);
 
-    struct vlc_executor_thread *thread;
-    vlc_list_foreach(thread, &executor->threads, node)
-    {
-        vlc_join(thread->thread, NULL);
-        free(thread);
-    }
+    /* No thread may be spawned at this point, so it is safe to read the
+     * thread count without mutex locked (the mutex must be released to join
+     * the threads). */
+
+    unsigned nthreads = atomic_load(&executor->nthreads);
+    for (unsigned i = 0; i < nthreads; ++i)
+        vlc_join(executor->threads[i].thread, NULL);
 
-    /* The queue must still be empty (no runnable submitted a new runnable) */
-    assert(vlc_list_is_empty(&executor->queue));
+    /* The queues must still be empty (no runnable submitted a new runnable) */
+    assert(atomic_load(&executor->pending) == 0);
 
     /* There are no tasks anymore */
-    assert(!executor->unfinished);
+    assert(!atomic_load(&executor->unfinished));
 
     free(executor);
 }
@@ -111,6 +111,271 @@ static const struct vlc_frame_callbacks vlc_frame_generic_cbs =
 /** Initial reserved header and footer size. */
 #define VLC_FRAME_PADDING      32
 
+/* Allocations from 256 bytes to 128 KiB are rounded up to the next quarter
+ * of a power of two, and recycled by the thread that made them, up to a
+ * bounded amount per thread. This avoids heap churn and fragmentation from
+ * the constant flow of similarly sized packets, without any lock: frames
+ * released by another thread are handed back to the owner through a bounded
+ * lock-free list. Disabled with ASan, which could otherwise not detect use
+ * after release. */
+#if !defined(__SANITIZE_ADDRESS__)
+# define VLC_FRAME_CACHE_MIN_SHIFT 8
+# define VLC_FRAME_CACHE_MAX_SHIFT 17
+# define VLC_FRAME_CACHE_CLASSES \
+    (4 * (VLC_FRAME_CACHE_MAX_SHIFT - VLC_FRAME_CACHE_MIN_SHIFT))
+/** Maximum memory retained by each thread in its free lists, and as much
+ * in its list of frames released by other threads */
+# define VLC_FRAME_CACHE_BYTES (1024 * 1024)
+
+struct vlc_frame_cache
+{
+    atomic_uint refs; /**< owner thread and frames in use */
+    vlc_frame_t *_Atomic remote; /**< frames released by other threads */
+    atomic_size_t remote_bytes; /**< memory retained in the remote list */
+    size_t bytes; /**< memory retained in the free lists */
+    vlc_frame_t *free[VLC_FRAME_CACHE_CLASSES];
+};
+
+struct vlc_frame_cached
+{
+    vlc_frame_t self;
+    struct vlc_frame_cache *cache;
+    unsigned cls;
+};
+
+static vlc_once_t vlc_frame_cache_once = VLC_STATIC_ONCE;
+/* The key is never deleted. Its destructor does not run for the main thread
+ * nor for threads not created by VLC: the cache of such a thread, bounded
+ * as above, is leaked when it exits. */
+static vlc_threadvar_t vlc_frame_cache_key;
+static bool vlc_frame_cache_ok;
+/** Marks the remote list of a cache whose owner thread has exited */
+static vlc_frame_t vlc_frame_cache_dead;
+
+static size_t vlc_frame_cache_Size(unsigned cls)
+{
+    unsigned shift = VLC_FRAME_CACHE_MIN_SHIFT + cls / 4;
+
+    return (size_t)(5 + cls % 4) << (shift - 2);
+}
+
+static int vlc_frame_cache_Class(size_t alloc)
+{
+    if (alloc <= ((size_t)1 << VLC_FRAME_CACHE_MIN_SHIFT)
+     || alloc > ((size_t)1 << VLC_FRAME_CACHE_MAX_SHIFT))
+        return -1;
+
+    unsigned m = alloc - 1;
+    unsigned shift = (sizeof (m) * 8 - 1) - vlc_clz(m);
+
+    return (shift - VLC_FRAME_CACHE_MIN_SHIFT) * 4 + (m >> (shift - 2)) - 4;
+}
+
+static void vlc_frame_cache_Unref(struct vlc_frame_cache *cache)
+{
+    if (atomic_fetch_sub_explicit(&cache->refs, 1, memory_order_acq_rel) == 1)
+        free(cache);
+}
+
+static void vlc_frame_cache_FreeList(vlc_frame_t *frame)
+{
+    while (frame != NULL)
+    {
+        vlc_frame_t *next = frame->p_next;
+
+        free(container_of(frame, struct vlc_frame_cached, self));
+        frame = next;
+    }
+}
+
+/* Must be called from the owner thread */
+static void vlc_frame_cache_Put(struct vlc_frame_cache *cache,
+                                vlc_frame_t *frame)
+{
+    struct vlc_frame_cached *cf =
+        container_of(frame, struct vlc_frame_cached, self);
+    const size_t size = vlc_frame_cache_Size(cf->cls);
+
+    if (cache->bytes + size <= VLC_FRAME_CACHE_BYTES)
+    {
+        frame->p_next = cache->free[cf->cls];
+        cache->free[cf->cls] = frame;
+        cache->bytes += size;
+    }
+    else
+        free(cf);
+}
+
+/* Must be called from the owner thread */
+static vlc_frame_t *vlc_frame_cache_Get(struct vlc_frame_cache *cache,
+                                        unsigned cls)
+{
+    vlc_frame_t *f = cache->free[cls];
+
+    if (f == NULL
+     && atomic_load_explicit(&cache->remote, memory_order_relaxed) != NULL)
+    {   /* Take back the frames released by other threads */
+        vlc_frame_t *list = atomic_exchange_explicit(&cache->remote, NULL,
+                                                     memory_order_acquire);
+        size_t remote_bytes = 0;
+
+        while (list != NULL)
+        {
+            vlc_frame_t *next = list->p_next;
+            struct vlc_frame_cached *cf =
+                container_of(list, struct vlc_frame_cached, self);
+
+            remote_bytes += vlc_frame_cache_Size(cf->cls);
+            vlc_frame_cache_Put(cache, list);
+            list = next;
+        }
+        atomic_fetch_sub_explicit(&cache->remote_bytes, remote_bytes,
+                                  memory_order_relaxed);
+        f = cache->free[cls];
+    }
+
+    if (f != NULL)
+    {
+        cache->free[cls] = f->p_next;
+        cache->bytes -= vlc_frame_cache_Size(cls);
+    }
+    return f;
+}
+
+static void vlc_frame_cache_Release(vlc_frame_t *frame)
+{
+    struct vlc_frame_cached *cf =
+        container_of(frame, struct vlc_frame_cached, self);
+    struct vlc_frame_cache *cache = cf->cache;
+
+    assert(frame->p_start == (unsigned char *)(cf + 1));
+
+    if (vlc_threadvar_get(vlc_frame_cache_key) == cache)
+        vlc_frame_cache_Put(cache, frame);
+    else
+    {   /* Hand the frame back to its owner thread, if it still exists and
+         * has not got too many pending already: it may not allocate again
+         * for a long time */
+        const size_t size = vlc_frame_cache_Size(cf->cls);
+
+        if (atomic_fetch_add_explicit(&cache->remote_bytes, size,
+                                      memory_order_relaxed) + size
+             > VLC_FRAME_CACHE_BYTES)
+        {
+            atomic_fetch_sub_explicit(&cache->remote_bytes, size,
+                                      memory_order_relaxed);
+            free(cf);
+        }
+        else
+        {
+            vlc_frame_t *head = atomic_load_explicit(&cache->remote,
+                                                     memory_order_relaxed);
+            do
+            {
+                if (head == &vlc_frame_cache_dead)
+                {
+                    free(cf);
+                    break;
+                }
+                frame->p_next = head;
+            }
+            while (!atomic_compare_exchange_weak_explicit(&cache->remote,
+                                                          &head, frame,
+                                                          memory_order_release,
+                                                          memory_order_relaxed));
+        }
+    }
+
+    vlc_frame_cache_Unref(cache);
+}
+
+static const struct vlc_frame_callbacks vlc_frame_cache_cbs =
+{
+    vlc_frame_cache_Release,
+};
+
+/* Called when the owner thread exits */
+static void vlc_frame_cache_Destroy(void *data)
+{
+    struct vlc_frame_cache *cache = data;
+
+    vlc_frame_cache_FreeList(atomic_exchange_explicit(&cache->remote,
+                                                      &vlc_frame_cache_dead,
+                                                      memory_order_acquire));
+    for (size_t i = 0; i < ARRAY_SIZE(cache->free); i++)
+        vlc_frame_cache_FreeList(cache->free[i]);
+    vlc_frame_cache_Unref(cache);
+}
+
+static void vlc_frame_cache_Init(void *data)
+{
+    (void) data;
+    vlc_frame_cache_ok = vlc_threadvar_create(&vlc_frame_cache_key,
+                                              vlc_frame_cache_Destroy) == 0;
+}
+
+static struct vlc_frame_cache *vlc_frame_cache_Self(void)
+{
+    vlc_once(&vlc_frame_cache_once, vlc_frame_cache_Init, NULL);
+    if (unlikely(!vlc_frame_cache_ok))
+        return NULL;
+
+    struct vlc_frame_cache *cache = vlc_threadvar_get(vlc_frame_cache_key);
+    if (cache == NULL)
+    {
+        cache = calloc(1, sizeof (*cache));
+        if (unlikely(cache == NULL))
+            return NULL;
+
+        atomic_init(&cache->refs, 1);
+        atomic_init(&cache->remote, NULL);
+        atomic_init(&cache->remote_bytes, 0);
+        if (unlikely(vlc_threadvar_set(vlc_frame_cache_key, cache)))
+        {
+            free(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+static vlc_frame_t *vlc_frame_cache_Alloc(size_t size)
+{
+    const int cls = vlc_frame_cache_Class(sizeof (struct vlc_frame_cached)
+                                          + size);
+    if (cls < 0)
+        return NULL;
+
+    struct vlc_frame_cache *cache = vlc_frame_cache_Self();
+    if (cache == NULL)
+        return NULL;
+
+    struct vlc_frame_cached *cf;
+    vlc_frame_t *f = vlc_frame_cache_Get(cache, cls);
+
+    if (f != NULL)
+        cf = container_of(f, struct vlc_frame_cached, self);
+    else
+    {
+        cf = malloc(vlc_frame_cache_Size(cls));
+        if (unlikely(cf == NULL))
+            return NULL;
+        cf->cache = cache;
+        cf->cls = cls;
+    }
+
+    atomic_fetch_add_explicit(&cache->refs, 1, memory_order_relaxed);
+    /* Only the requested size is exposed, not the rounding of the class */
+    return vlc_frame_Init(&cf->self, &vlc_frame_cache_cbs, cf + 1, size);
+}
+#else
+static vlc_frame_t *vlc_frame_cache_Alloc(size_t size)
+{
+    (void) size;
+    return NULL;
+}
+#endif
+
 vlc_frame_t *vlc_frame_Alloc (size_t size)
 {
     if (unlikely(size >> 28))
@@ -125,11 +390,16 @@ vlc_frame_t *vlc_frame_Alloc (size_t size)
     if (unlikely(alloc <= size))
         return NULL;
 
-    vlc_frame_t *f = malloc (alloc);
-    if (unlikely(f == NULL))
-        return NULL;
+    vlc_frame_t *f = vlc_frame_cache_Alloc(alloc - sizeof (*f));
+    if (f == NULL)
+    {
+        f = malloc (alloc);
+        if (unlikely(f == NULL))
+            return NULL;
+
+        vlc_frame_Init(f, &vlc_frame_generic_cbs, f + 1, alloc - sizeof (*f));
+    }
 
-    vlc_frame_Init(f, &vlc_frame_generic_cbs, f + 1, alloc - sizeof (*f));
     static_assert ((VLC_FRAME_PADDING % VLC_FRAME_ALIGN) == 0,
                    "VLC_FRAME_PADDING must be a multiple of VLC_FRAME_ALIGN");
     f->p_buffer += VLC_FRAME_PADDING + VLC_FRAME_ALIGN - 1;
@@ -35,16 +35,23 @@
 #include <vlc_atomic.h>
 #include "picture.h"
 
-#define POOL_MAX (CHAR_BIT * sizeof (unsigned long long))
+/* The pool is aligned on POOL_MAX bytes, so that the picture offset can be
+ * stored in the low bits of the pool pointer of each clone. */
+#define POOL_MAX 1024
+#define POOL_WORD_BITS (CHAR_BIT * sizeof (unsigned long long))
+#define POOL_WORDS (POOL_MAX / POOL_WORD_BITS)
 
 static_assert ((POOL_MAX & (POOL_MAX - 1)) == 0, "Not a power of two");
+static_assert ((POOL_MAX % POOL_WORD_BITS) == 0, "Not a multiple of words");
 
 struct picture_pool_t {
+    /* Only used to wait for, or to signal, available pictures */
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
-    bool               canceled;
-    unsigned long long available;
+    atomic_bool        canceled;
+    atomic_uint        waiters;
+    atomic_ullong      available[POOL_WORDS];
     vlc_atomic_rc_t    refs;
     unsigned short     picture_count;
     picture_t  *picture[];
@@ -72,14 +79,24 @@ static void picture_pool_ReleaseClone(picture_t *clone)
     picture_pool_t *pool = (void *)(sys & ~(POOL_MAX - 1));
     unsigned offset = sys & (POOL_MAX - 1);
     picture_t *picture = pool->picture[offset];
+    const unsigned long long bit = 1ULL << (offset % POOL_WORD_BITS);
 
     picture_Release(picture);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
+    unsigned long long prev =
+        atomic_fetch_or(&pool->available[offset / POOL_WORD_BITS], bit);
+    assert(!(prev & bit));
+    (void) prev;
+
+    /* Pairs with the fence in picture_pool_Wait(), so that either the
+     * waiter sees the picture, or we see the waiter. */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
 
     picture_pool_Destroy(pool);
 }
@@ -99,6 +116,35 @@ static picture_t *picture_pool_ClonePicture(picture_pool_t *pool,
     return clone;
 }
 
+/**
+ * Claims an available picture, without waiting.
+ *
+ * \return the picture offset, or -1 if none is available
+ */
+static int picture_pool_Claim(picture_pool_t *pool)
+{
+    const unsigned words = (pool->picture_count + POOL_WORD_BITS - 1)
+                         / POOL_WORD_BITS;
+
+    for (unsigned w = 0; w < words; w++)
+    {
+        unsigned long long available = atomic_load_explicit(&pool->available[w],
+                                                            memory_order_relaxed);
+        while (available != 0)
+        {
+            const unsigned long long bit = 1ULL << ctz(available);
+
+            if (atomic_compare_exchange_weak_explicit(&pool->available[w],
+                                                      &available,
+                                                      available & ~bit,
+                                                      memory_order_acquire,
+                                                      memory_order_relaxed))
+                return w * POOL_WORD_BITS + ctz(bit);
+        }
+    }
+    return -1;
+}
+
 picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
 {
     if (unlikely(count > POOL_MAX))
@@ -114,14 +160,23 @@ picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
 
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
-    if (count == POOL_MAX)
-        pool->available = ~0ULL;
-    else
-        pool->available = (1ULL << count) - 1;
+    for (unsigned w = 0; w < POOL_WORDS; w++)
+    {
+        unsigned long long available;
+
+        if (count >= (w + 1) * POOL_WORD_BITS)
+            available = ~0ULL;
+        else if (count > w * POOL_WORD_BITS)
+            available = (1ULL << (count - w * POOL_WORD_BITS)) - 1;
+        else
+            available = 0;
+        atomic_init(&pool->available[w], available);
+    }
+    atomic_init(&pool->waiters, 0);
     vlc_atomic_rc_init(&pool->refs);
     pool->picture_count = count;
     memcpy(pool->picture, tab, count * sizeof (picture_t *));
-    pool->canceled = false;
+    atomic_init(&pool->canceled, false);
     return pool;
 }
 
@@ -180,50 +235,44 @@ error:
 
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-    unsigned long long available;
-
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
-    available = pool->available;
-
-    while (available != 0)
-    {
-        int i = ctz(available);
 
-        if (unlikely(pool->canceled))
-            break;
-
-        pool->available &= ~(1ULL << i);
-        vlc_mutex_unlock(&pool->lock);
-        available &= ~(1ULL << i);
+    if (unlikely(atomic_load_explicit(&pool->canceled, memory_order_relaxed)))
+        return NULL;
 
-        return picture_pool_ClonePicture(pool, i);
-    }
+    int i = picture_pool_Claim(pool);
+    if (i < 0)
+        return NULL;
 
-    vlc_mutex_unlock(&pool->lock);
-    return NULL;
+    return picture_pool_ClonePicture(pool, i);
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
+    int i;
+
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    while (pool->available == 0)
+    i = picture_pool_Claim(pool);
+    if (i >= 0)
+        return picture_pool_ClonePicture(pool, i);
+
+    vlc_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->waiters, 1);
+    /* The claim loads are relaxed: order them after the increment. */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    while ((i = picture_pool_Claim(pool)) < 0)
     {
-        if (pool->canceled)
-        {
-            vlc_mutex_unlock(&pool->lock);
-            return NULL;
-        }
+        if (atomic_load_explicit(&pool->canceled, memory_order_relaxed))
+            break;
         vlc_cond_wait(&pool->wait, &pool->lock);
     }
 
-    int i = ctz(pool->available);
-    pool->available &= ~(1ULL << i);
+    atomic_fetch_sub(&pool->waiters, 1);
     vlc_mutex_unlock(&pool->lock);
 
-    return picture_pool_ClonePicture(pool, i);
+    return (i >= 0) ? picture_pool_ClonePicture(pool, i) : NULL;
 }
 
 void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
@@ -231,7 +280,7 @@ void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
     vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    pool->canceled = canceled;
+    atomic_store_explicit(&pool->canceled, canceled, memory_order_relaxed);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
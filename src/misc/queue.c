@@ -75,6 +75,7 @@ void vlc_queue_Init(vlc_queue_t *q, ptrdiff_t next_offset)
     q->next_offset = next_offset;
     vlc_mutex_init(&q->lock);
     vlc_cond_init(&q->wait);
+    q->waiters = 0;
 }
 
 void vlc_queue_EnqueueUnlocked(vlc_queue_t *q, void *entry)
@@ -90,7 +91,11 @@ void vlc_queue_EnqueueUnlocked(vlc_queue_t *q, void *entry)
         lastp = next_p(entry, offset);
 
     q->lastp = lastp;
-    vlc_queue_Signal(q);
+
+    /* Waiters can only be added while holding the lock: if there are none,
+     * skip the condition variable, and its own lock, entirely. */
+    if (q->waiters > 0)
+        vlc_queue_Signal(q);
 }
 
 void *vlc_queue_DequeueUnlocked(vlc_queue_t *q)
@@ -345,7 +345,13 @@ int input_preparser_Push( input_preparser_t *preparser,
 
     PreparserAddTask(preparser, task);
 
-    vlc_executor_Submit(preparser->executor, &task->runnable);
+    /* Interactive requests go ahead of background ones (e.g. a library
+     * scan) */
+    enum vlc_executor_priority priority =
+        i_options & META_REQUEST_OPTION_DO_INTERACT
+            ? VLC_EXECUTOR_PRIORITY_HIGH : VLC_EXECUTOR_PRIORITY_NORMAL;
+    vlc_executor_SubmitPriority(preparser->executor, &task->runnable,
+                                priority);
     return VLC_SUCCESS;
 }
 
@@ -86,11 +86,77 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static block_t *test_chain_block (const char *str, size_t headroom)
+{
+    size_t len = strlen (str);
+    block_t *block = block_Alloc (headroom + len);
+    assert (block != NULL);
+    block->p_buffer += headroom;
+    block->i_buffer = len;
+    memcpy (block->p_buffer, str, len);
+    return block;
+}
+
+static void test_block_ChainGather (void)
+{
+    /* fits around the largest block: gathered in place */
+    block_t *chain = test_chain_block ("ab", 0);
+    chain->i_pts = 42;
+    block_t *largest = test_chain_block ("0123456789", 8);
+    chain->p_next = largest;
+    largest->p_next = test_chain_block ("yz", 0);
+
+    block_t *block = block_ChainGather (chain);
+    assert (block == largest);
+    assert (block->p_next == NULL);
+    assert (block->i_pts == 42);
+    assert (block->i_buffer == 14);
+    assert (!memcmp (block->p_buffer, "ab0123456789yz", 14));
+    block_Release (block);
+
+    /* largest block at the head: keeps its own properties */
+    chain = test_chain_block ("0123456789", 0);
+    chain->i_flags = BLOCK_FLAG_DISCONTINUITY;
+    chain->i_pts = 1000;
+    chain->i_dts = 900;
+    largest = chain;
+    chain->p_next = test_chain_block ("yz", 0);
+    chain->p_next->i_pts = chain->p_next->i_dts = VLC_TICK_INVALID;
+
+    block = block_ChainGather (chain);
+    assert (block == largest);
+    assert (block->p_next == NULL);
+    assert (block->i_flags == BLOCK_FLAG_DISCONTINUITY);
+    assert (block->i_pts == 1000);
+    assert (block->i_dts == 900);
+    assert (block->i_buffer == 12);
+    assert (!memcmp (block->p_buffer, "0123456789yz", 12));
+    block_Release (block);
+
+    /* does not fit in the head room: copied */
+    char head[129], body[257];
+    memset (head, 'h', sizeof (head) - 1);
+    head[sizeof (head) - 1] = '\0';
+    memset (body, 'b', sizeof (body) - 1);
+    body[sizeof (body) - 1] = '\0';
+    chain = test_chain_block (head, 0);
+    largest = test_chain_block (body, 0);
+    chain->p_next = largest;
+
+    block = block_ChainGather (chain);
+    assert (block != NULL && block != largest);
+    assert (block->i_buffer == 128 + 256);
+    assert (!memcmp (block->p_buffer, head, 128));
+    assert (!memcmp (block->p_buffer + 128, body, 256));
+    block_Release (block);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_ChainGather ();
     return 0;
 }
 
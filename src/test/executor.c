@@ -271,6 +271,91 @@ static void test_task_chain(void)
         assert(array[i] == 2 * i);
 }
 
+struct ordered_data
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    bool blocked;
+    int ended;
+    int order[11];
+};
+
+struct ordered_task
+{
+    struct ordered_data *data;
+    int id;
+    struct vlc_runnable runnable;
+};
+
+static void RunBlocker(void *userdata)
+{
+    struct ordered_data *data = userdata;
+
+    vlc_mutex_lock(&data->lock);
+    while (data->blocked)
+        vlc_cond_wait(&data->cond, &data->lock);
+    vlc_mutex_unlock(&data->lock);
+}
+
+static void RunOrdered(void *userdata)
+{
+    struct ordered_task *task = userdata;
+    struct ordered_data *data = task->data;
+
+    vlc_mutex_lock(&data->lock);
+    data->order[data->ended++] = task->id;
+    vlc_mutex_unlock(&data->lock);
+}
+
+static void test_priority(void)
+{
+    vlc_executor_t *executor = vlc_executor_New(1);
+    assert(executor);
+
+    struct ordered_data data;
+    vlc_mutex_init(&data.lock);
+    vlc_cond_init(&data.cond);
+    data.blocked = true;
+    data.ended = 0;
+
+    /* Keep the only thread busy while submitting */
+    struct vlc_runnable blocker = {
+        .run = RunBlocker,
+        .userdata = &data,
+    };
+    vlc_executor_Submit(executor, &blocker);
+
+    struct ordered_task tasks[11];
+    for (int i = 0; i < 11; ++i)
+    {
+        struct ordered_task *task = &tasks[i];
+        task->data = &data;
+        task->id = i;
+        task->runnable.run = RunOrdered;
+        task->runnable.userdata = task;
+    }
+
+    for (int i = 0; i < 10; ++i)
+        vlc_executor_Submit(executor, &tasks[i].runnable);
+    vlc_executor_SubmitPriority(executor, &tasks[10].runnable,
+                                VLC_EXECUTOR_PRIORITY_HIGH);
+
+    vlc_mutex_lock(&data.lock);
+    data.blocked = false;
+    vlc_cond_signal(&data.cond);
+    vlc_mutex_unlock(&data.lock);
+
+    vlc_executor_WaitIdle(executor);
+    vlc_executor_Delete(executor);
+
+    /* The high priority task must have been run first, then the other ones in
+     * submission order */
+    assert(data.ended == 11);
+    assert(data.order[0] == 10);
+    for (int i = 1; i < 11; ++i)
+        assert(data.order[i] == i - 1);
+}
+
 int main(void)
 {
     test_single_runnable();
@@ -278,5 +363,6 @@ int main(void)
     test_blocking_delete();
     test_cancel();
     test_task_chain();
+    test_priority();
     return 0;
 }
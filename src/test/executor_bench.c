@@ -0,0 +1,148 @@
+/*****************************************************************************
+ * src/test/executor_bench.c
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_executor.h>
+#include <vlc_tick.h>
+
+struct doubler_task
+{
+    vlc_executor_t *executor;
+    int *array;
+    size_t count;
+    struct vlc_runnable runnable;
+};
+
+static void DoublerRun(void *);
+
+static bool
+SpawnDoublerTask(vlc_executor_t *executor, int *array, size_t count)
+{
+    struct doubler_task *task = malloc(sizeof(*task));
+    if (!task)
+        return false;
+
+    task->executor = executor;
+    task->array = array;
+    task->count = count;
+    task->runnable.run = DoublerRun;
+    task->runnable.userdata = task;
+
+    vlc_executor_Submit(executor, &task->runnable);
+
+    return true;
+}
+
+static void DoublerRun(void *userdata)
+{
+    struct doubler_task *task = userdata;
+
+    if (task->count == 1)
+        task->array[0] *= 2; /* double the value */
+    else
+    {
+        /* Spawn tasks doubling halves of the array recursively */
+        bool ok;
+
+        ok = SpawnDoublerTask(task->executor, task->array, task->count / 2);
+        assert(ok);
+
+        ok = SpawnDoublerTask(task->executor, task->array + task->count / 2,
+                                              task->count - task->count / 2);
+        assert(ok);
+    }
+
+    free(task);
+}
+
+static void RunNothing(void *userdata)
+{
+    atomic_uint *count = userdata;
+    atomic_fetch_add_explicit(count, 1, memory_order_relaxed);
+}
+
+static void test_throughput(unsigned nthreads)
+{
+    enum { COUNT = 100000 };
+
+    vlc_executor_t *executor = vlc_executor_New(nthreads);
+    assert(executor);
+
+    struct vlc_runnable *runnables = malloc(COUNT * sizeof(*runnables));
+    assert(runnables);
+
+    atomic_uint count = 0;
+
+    vlc_tick_t start = vlc_tick_now();
+    for (int i = 0; i < COUNT; ++i)
+    {
+        struct vlc_runnable *runnable = &runnables[i];
+        runnable->run = RunNothing;
+        runnable->userdata = &count;
+        vlc_executor_Submit(executor, runnable);
+    }
+    vlc_executor_WaitIdle(executor);
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    assert(atomic_load(&count) == COUNT);
+
+    /* Measure the submission from the executor threads with the doubler tasks
+     * (each task spawns two smaller tasks) */
+    int *array = malloc(COUNT * sizeof(*array));
+    assert(array);
+    for (int i = 0; i < COUNT; ++i)
+        array[i] = i;
+
+    start = vlc_tick_now();
+    SpawnDoublerTask(executor, array, COUNT);
+    vlc_executor_WaitIdle(executor);
+    vlc_tick_t elapsed_chain = vlc_tick_now() - start;
+
+    for (int i = 0; i < COUNT; ++i)
+        assert(array[i] == 2 * i);
+
+    vlc_executor_Delete(executor);
+    free(array);
+    free(runnables);
+
+    printf("executor with %u threads: %d tasks in %" PRId64 " us, "
+           "%d chained tasks in %" PRId64 " us\n", nthreads,
+           COUNT, US_FROM_VLC_TICK(elapsed),
+           2 * COUNT - 1, US_FROM_VLC_TICK(elapsed_chain));
+}
+
+int main(void)
+{
+    test_throughput(1);
+    test_throughput(4);
+    test_throughput(16);
+    return 0;
+}
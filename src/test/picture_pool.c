@@ -108,6 +108,50 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+/* More pictures than bits in a word of the pool availability bitmap, with
+ * the last word partially used */
+#define LARGE_PICTURES 130
+
+static void test_large(void)
+{
+    picture_t *pics[LARGE_PICTURES];
+    video_format_t small;
+
+    video_format_Setup(&small, VLC_CODEC_I420, 16, 16, 16, 16, 1, 1);
+    pool = picture_pool_NewFromFormat(&small, LARGE_PICTURES);
+    assert(pool != NULL);
+
+    for (unsigned i = 0; i < LARGE_PICTURES; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+        for (unsigned j = 0; j < i; j++)
+            assert(pics[j] != pics[i]);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+
+    /* Free one picture in each word, and get them back */
+    for (unsigned i = 1; i < LARGE_PICTURES; i += 64)
+        picture_Release(pics[i]);
+    for (unsigned i = 1; i < LARGE_PICTURES; i += 64) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+
+    for (unsigned i = 0; i < LARGE_PICTURES; i++)
+        picture_Release(pics[i]);
+
+    for (unsigned i = 0; i < LARGE_PICTURES; i++) {
+        pics[i] = picture_pool_Wait(pool);
+        assert(pics[i] != NULL);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+
+    for (unsigned i = 0; i < LARGE_PICTURES; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(pool);
+}
+
 int main(void)
 {
     video_format_Setup(&fmt, VLC_CODEC_I420, 320, 200, 320, 200, 1, 1);
@@ -123,6 +167,7 @@ int main(void)
 
     test(false);
     test(true);
+    test_large();
 
     return 0;
 }
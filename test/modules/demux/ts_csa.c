@@ -0,0 +1,145 @@
+/*****************************************************************************
+ * ts_csa.c: CSA scalar vs batch (de)scrambling tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include <vlc_common.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include "../../../modules/mux/mpeg/csa.h"
+
+const char vlc_module_name[] = "ts_csa";
+
+#define PACKETS (2 * CSA_BATCH_SIZE + 13)
+
+static uint32_t seed = 0x1234;
+
+static uint8_t rnd(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+static void fill(uint8_t pkts[][188])
+{
+    for (unsigned i = 0; i < PACKETS; i++)
+    {
+        uint8_t *p = pkts[i];
+
+        for (unsigned j = 0; j < 188; j++)
+            p[j] = rnd();
+        p[0] = 0x47;
+        p[1] &= 0x1f;
+        /* all scrambling control values, with and without adaptation */
+        p[3] = ((i % 4) << 6) | ((i & 4) ? 0x30 : 0x10) | (i & 0x0f);
+        if (p[3] & 0x20)
+            p[4] = (i * 7) % 184;
+    }
+}
+
+static int check(vlc_object_t *obj, csa_t *csa, int pkt_size)
+{
+    static uint8_t scalar[PACKETS][188], batch[PACKETS][188];
+    uint8_t *pp_pkts[PACKETS];
+
+    fill(scalar);
+    memcpy(batch, scalar, sizeof (batch));
+    for (unsigned i = 0; i < PACKETS; i++)
+    {
+        csa_Decrypt(csa, scalar[i], pkt_size);
+        pp_pkts[i] = batch[i];
+    }
+    csa_DecryptBatch(csa, pp_pkts, PACKETS, pkt_size);
+
+    for (unsigned i = 0; i < PACKETS; i++)
+        if (memcmp(scalar[i], batch[i], 188))
+        {
+            fprintf(stderr, "decrypt mismatch size %d packet %u\n",
+                    pkt_size, i);
+            return 1;
+        }
+
+    for (int odd = 0; odd < 2; odd++)
+    {
+        csa_UseKey(obj, csa, odd);
+        fill(scalar);
+        memcpy(batch, scalar, sizeof (batch));
+        for (unsigned i = 0; i < PACKETS; i++)
+        {
+            scalar[i][3] &= 0x3f;
+            batch[i][3] &= 0x3f;
+            csa_Encrypt(csa, scalar[i], pkt_size);
+            pp_pkts[i] = batch[i];
+        }
+        csa_EncryptBatch(csa, pp_pkts, PACKETS, pkt_size);
+
+        for (unsigned i = 0; i < PACKETS; i++)
+            if (memcmp(scalar[i], batch[i], 188))
+            {
+                fprintf(stderr, "encrypt mismatch size %d packet %u\n",
+                        pkt_size, i);
+                return 1;
+            }
+
+        /* and back */
+        csa_DecryptBatch(csa, pp_pkts, PACKETS, pkt_size);
+        for (unsigned i = 0; i < PACKETS; i++)
+            csa_Decrypt(csa, scalar[i], pkt_size);
+        for (unsigned i = 0; i < PACKETS; i++)
+            if (memcmp(scalar[i], batch[i], 188))
+            {
+                fprintf(stderr, "roundtrip mismatch size %d packet %u\n",
+                        pkt_size, i);
+                return 1;
+            }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 1;
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    csa_t *csa = csa_New();
+    if (csa == NULL)
+    {
+        libvlc_release(vlc);
+        return 1;
+    }
+
+    char even[] = "0x1122334455667788", odd[] = "0x99aabbccddeeff00";
+    int ret = csa_SetCW(obj, csa, even, false) || csa_SetCW(obj, csa, odd, true);
+
+    static const int sizes[] = { 188, 184, 101, 12 };
+    for (size_t i = 0; ret == 0 && i < ARRAY_SIZE(sizes); i++)
+        ret = check(obj, csa, sizes[i]);
+
+    csa_Delete(csa);
+    libvlc_release(vlc);
+    return ret;
+}
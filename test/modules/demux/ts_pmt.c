@@ -0,0 +1,290 @@
+/*****************************************************************************
+ * ts_pmt.c: MPEG TS PMT within a batch of walked packets
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+
+/* The PMT callback probes the stream boundaries, seeking the stream while
+ * the demuxer walks packets in place from its peek buffer. The PES packets
+ * following the PMT in the same batch must still be read intact. */
+
+#define PID_PMT     0x100
+#define PID_ES      0x101
+#define NULL_PKTS   10
+#define PES_PKTS    200
+#define PAYLOAD     162
+#define TS_PKTS     (1 + NULL_PKTS + 1 + PES_PKTS)
+
+struct test_es_out
+{
+    es_out_t out;
+    es_out_id_t *id;
+    int i_next;     /* expected payload value */
+    int i_received;
+    bool b_error;
+};
+
+struct es_out_id_t
+{
+    int dummy;
+};
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    (void) in;
+    struct test_es_out *ctx = container_of(out, struct test_es_out, out);
+
+    if (fmt->i_cat != AUDIO_ES || ctx->id != NULL)
+        return NULL;
+    ctx->id = malloc(sizeof (*ctx->id));
+    return ctx->id;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct test_es_out *ctx = container_of(out, struct test_es_out, out);
+
+    assert(id == ctx->id);
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        if (block->i_buffer != PAYLOAD)
+        {
+            fprintf(stderr, "PES %d: size %zu\n", ctx->i_received,
+                    block->i_buffer);
+            ctx->b_error = true;
+        }
+        else
+        {
+            /* the first payloads can be dropped, waiting for the PMT */
+            if (ctx->i_received == 0)
+                ctx->i_next = block->p_buffer[0];
+            for (size_t i = 0; i < block->i_buffer; i++)
+                if (block->p_buffer[i] != (ctx->i_next & 0xff))
+                {
+                    fprintf(stderr, "PES %d: corrupted at %zu\n",
+                            ctx->i_received, i);
+                    ctx->b_error = true;
+                    break;
+                }
+            ctx->i_next++;
+            ctx->i_received++;
+        }
+        block_Release(block);
+        block = next;
+    }
+    return VLC_SUCCESS;
+}
+
+static void EsOutDelete(es_out_t *out, es_out_id_t *id)
+{
+    struct test_es_out *ctx = container_of(out, struct test_es_out, out);
+
+    assert(id == ctx->id);
+    free(id);
+    ctx->id = NULL;
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    (void) out; (void) in;
+
+    switch (query)
+    {
+        case ES_OUT_GET_ES_STATE:
+            (void) va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_EMPTY:
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_GET_PCR_SYSTEM:
+        case ES_OUT_MODIFY_PCR_SYSTEM:
+            return VLC_EGENERIC;
+        default:
+            return VLC_SUCCESS;
+    }
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDelete,
+    .control = EsOutControl,
+};
+
+static uint32_t Crc32(const uint8_t *p, size_t i_size)
+{
+    uint32_t i_crc = 0xffffffff;
+
+    while (i_size--)
+    {
+        i_crc ^= (uint32_t)*p++ << 24;
+        for (int i = 0; i < 8; i++)
+            i_crc = (i_crc & 0x80000000) ? (i_crc << 1) ^ 0x04c11db7
+                                         : i_crc << 1;
+    }
+    return i_crc;
+}
+
+static void WriteHeader(uint8_t *p, uint16_t i_pid, bool b_start,
+                        uint8_t i_adaptation, uint8_t *pi_cc)
+{
+    p[0] = 0x47;
+    p[1] = (b_start ? 0x40 : 0x00) | (i_pid >> 8);
+    p[2] = i_pid & 0xff;
+    p[3] = i_adaptation | (*pi_cc & 0x0f);
+    *pi_cc += 1;
+}
+
+static void WriteSection(uint8_t *p, uint16_t i_pid, uint8_t *pi_cc,
+                         const uint8_t *p_section, size_t i_section)
+{
+    uint8_t *s = &p[5];
+
+    memset(p, 0xff, 188);
+    WriteHeader(p, i_pid, true, 0x10, pi_cc);
+    p[4] = 0; /* pointer_field */
+    memcpy(s, p_section, i_section);
+    s[1] = 0xb0 | ((i_section + 4 - 3) >> 8);
+    s[2] = (i_section + 4 - 3) & 0xff;
+    uint32_t i_crc = Crc32(s, i_section);
+    SetDWBE(&s[i_section], i_crc);
+}
+
+static void WritePES(uint8_t *p, uint8_t *pi_cc, unsigned i_pes)
+{
+    const uint64_t i_pcr = 90000 + i_pes * 3600;
+    const uint64_t i_pts = i_pcr + 9000;
+
+    WriteHeader(p, PID_ES, true, 0x30, pi_cc);
+    p[4] = 7; /* adaptation field length */
+    p[5] = 0x10; /* PCR */
+    p[6] = i_pcr >> 25;
+    p[7] = i_pcr >> 17;
+    p[8] = i_pcr >> 9;
+    p[9] = i_pcr >> 1;
+    p[10] = ((i_pcr & 1) << 7) | 0x7e;
+    p[11] = 0;
+
+    uint8_t *h = &p[12];
+    h[0] = 0x00; h[1] = 0x00; h[2] = 0x01; h[3] = 0xc0;
+    SetWBE(&h[4], 3 + 5 + PAYLOAD);
+    h[6] = 0x80;
+    h[7] = 0x80; /* PTS only */
+    h[8] = 5;
+    h[9] = 0x21 | ((i_pts >> 29) & 0x0e);
+    h[10] = i_pts >> 22;
+    h[11] = ((i_pts >> 14) & 0xfe) | 1;
+    h[12] = i_pts >> 7;
+    h[13] = ((i_pts << 1) & 0xfe) | 1;
+    memset(&h[14], i_pes & 0xff, PAYLOAD);
+}
+
+static uint8_t *CreateTS(void)
+{
+    static const uint8_t pat[] = {
+        0x00, 0x00, 0x00,       /* table_id, section_length */
+        0x00, 0x01, 0xc1, 0x00, 0x00,
+        0x00, 0x01, 0xe0 | (PID_PMT >> 8), PID_PMT & 0xff,
+    };
+    static const uint8_t pmt[] = {
+        0x02, 0x00, 0x00,       /* table_id, section_length */
+        0x00, 0x01, 0xc1, 0x00, 0x00,
+        0xe0 | (PID_ES >> 8), PID_ES & 0xff, /* PCR PID */
+        0xf0, 0x00,
+        0x03, 0xe0 | (PID_ES >> 8), PID_ES & 0xff, 0xf0, 0x00,
+    };
+    uint8_t cc_pat = 0, cc_pmt = 0, cc_null = 0, cc_es = 0;
+
+    uint8_t *p_ts = malloc(TS_PKTS * 188);
+    if (p_ts == NULL)
+        return NULL;
+
+    uint8_t *p = p_ts;
+    WriteSection(p, 0x0000, &cc_pat, pat, sizeof (pat));
+    p += 188;
+    /* so that the PMT is in the middle of the next batch */
+    for (unsigned i = 0; i < NULL_PKTS; i++, p += 188)
+    {
+        memset(p, 0xff, 188);
+        WriteHeader(p, 0x1fff, false, 0x10, &cc_null);
+    }
+    WriteSection(p, PID_PMT, &cc_pmt, pmt, sizeof (pmt));
+    p += 188;
+    for (unsigned i = 0; i < PES_PKTS; i++, p += 188)
+        WritePES(p, &cc_es, i);
+
+    return p_ts;
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 1;
+
+    uint8_t *p_ts = CreateTS();
+    assert(p_ts != NULL);
+
+    /* the memory stream can seek fast, and its peek buffer is released
+     * when seeking */
+    stream_t *s = vlc_stream_MemoryNew(vlc->p_libvlc_int, p_ts,
+                                       TS_PKTS * 188, false);
+    assert(s != NULL);
+
+    struct test_es_out ctx = { .out = { .cbs = &es_out_cbs } };
+    demux_t *demux = demux_New(VLC_OBJECT(vlc->p_libvlc_int), "ts",
+                               "file:///test.ts", s, &ctx.out);
+    if (demux == NULL)
+    {
+        /* no dvbpsi */
+        vlc_stream_Delete(s);
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    while (demux_Demux(demux) == VLC_DEMUXER_SUCCESS);
+    demux_Delete(demux);
+    libvlc_release(vlc);
+
+    fprintf(stderr, "received %d PES, last %d\n", ctx.i_received,
+            ctx.i_next - 1);
+    if (ctx.b_error || ctx.i_received < PES_PKTS - 2 ||
+        ctx.i_next - 1 < PES_PKTS - 2)
+        return 1;
+    return 0;
+}
@@ -49,7 +49,7 @@ static int check_set( const uint8_t *p_set, const uint8_t *p_end,
         p = pf_find( p, p_end );
         if( p == NULL )
             break;
-        printf("- entry %zu offset %ld\n", i_entry, p - p_set);
+        printf("- entry %zu offset %td\n", i_entry, p - p_set);
         if( i_entry == i_results )
             break;
         if( p_results[i_entry].offset + i_results_offset != (size_t) (p - p_set) )
@@ -76,20 +76,145 @@ static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
     if( i_ret != 0 )
         return i_ret;
 
-    /* Perform same tests on simd optimized code */
-    if( startcode_FindAnnexB_Bits != startcode_FindAnnexB )
+    /* Perform same tests on each simd optimized code */
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
     {
-        printf("checking asm:\n");
+        printf("checking sse2 code:\n");
         i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                           startcode_FindAnnexB );
+                           startcode_FindAnnexB_SSE2 );
         if( i_ret != 0 )
             return i_ret;
     }
-    else printf("asm not built in, skipping test:\n");
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        printf("checking avx2 code:\n");
+        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                           startcode_FindAnnexB_AVX2 );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+#endif
+#ifdef CAN_COMPILE_STARTCODE_NEON
+    printf("checking neon code:\n");
+    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                       startcode_FindAnnexB_NEON );
+    if( i_ret != 0 )
+        return i_ret;
+#endif
 
     return 0;
 }
 
+static int check_same( const uint8_t *p_set, const uint8_t *p_end,
+                       const uint8_t *(*pf_find)(const uint8_t *, const uint8_t *))
+{
+    for( const uint8_t *p = p_set; p < p_end; p++ )
+    {
+        const uint8_t *p_ref = startcode_FindAnnexB_Bits( p, p_end );
+        if( pf_find( p, p_end ) != p_ref )
+        {
+            printf("- mismatch from offset %td\n", p - p_set);
+            return 1;
+        }
+        if( p_ref == NULL )
+            break;
+        p = p_ref;
+    }
+    return 0;
+}
+
+static int run_random_set( const uint8_t *p_set, const uint8_t *p_end )
+{
+    int i_ret = check_same( p_set, p_end, startcode_FindAnnexB );
+#ifdef CAN_COMPILE_SSE2
+    if( i_ret == 0 && vlc_CPU_SSE2() )
+        i_ret = check_same( p_set, p_end, startcode_FindAnnexB_SSE2 );
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if( i_ret == 0 && vlc_CPU_AVX2() )
+        i_ret = check_same( p_set, p_end, startcode_FindAnnexB_AVX2 );
+#endif
+#ifdef CAN_COMPILE_STARTCODE_NEON
+    if( i_ret == 0 )
+        i_ret = check_same( p_set, p_end, startcode_FindAnnexB_NEON );
+#endif
+    return i_ret;
+}
+
+static int run_random_sets( const uint8_t *p_set, size_t i_set )
+{
+    /* all start and end alignments, and searches starting close to the end,
+     * where the vector code hands over to its scalar tail */
+    for( size_t i_end = i_set - 64; i_end <= i_set; i_end++ )
+    {
+        for( size_t i_start = 0; i_start < 64; i_start++ )
+        {
+            if( run_random_set( &p_set[i_start], &p_set[i_end] ) != 0 )
+            {
+                printf("failed on [%zu,%zu]\n", i_start, i_end);
+                return 1;
+            }
+        }
+        for( size_t i_start = i_end - 32; i_start < i_end; i_start++ )
+        {
+            if( run_random_set( &p_set[i_start], &p_set[i_end] ) != 0 )
+            {
+                printf("failed on [%zu,%zu]\n", i_start, i_end);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int run_bytestream_set( const uint8_t *p_set, size_t i_set )
+{
+    static const uint8_t startcode[3] = { 0, 0, 1 };
+    block_bytestream_t bytestream;
+    block_BytestreamInit( &bytestream );
+
+    /* split in small blocks so that startcodes cross boundaries */
+    for( size_t i = 0; i < i_set; )
+    {
+        size_t i_size = __MIN( 1 + i % 7, i_set - i );
+        block_t *p_block = block_Alloc( i_size );
+        if( !p_block )
+        {
+            block_BytestreamRelease( &bytestream );
+            return 1;
+        }
+        memcpy( p_block->p_buffer, &p_set[i], i_size );
+        block_BytestreamPush( &bytestream, p_block );
+        i += i_size;
+    }
+
+    int i_ret = 0;
+    size_t i_offset = 0;
+    for( const uint8_t *p = p_set; ; p++ )
+    {
+        const uint8_t *p_ref = startcode_FindAnnexB_Bits( p, &p_set[i_set] );
+        int i_found = block_FindStartcodeFromOffset( &bytestream, &i_offset,
+                                                     startcode, 3, NULL, NULL );
+        if( (i_found == VLC_SUCCESS) != (p_ref != NULL) ||
+            (p_ref && i_offset != (size_t)(p_ref - p_set)) )
+        {
+            printf("- bytestream mismatch at offset %zu\n", i_offset);
+            i_ret = 1;
+            break;
+        }
+        if( p_ref == NULL )
+            break;
+        p = p_ref;
+        i_offset++;
+    }
+
+    block_BytestreamRelease( &bytestream );
+    return i_ret;
+}
+
 int main( void )
 {
     const uint8_t test1_annexbdata[] = { 0, 0, 0, 1, 0x55, 0x55, 0x55, 0x55, 0x55, // 9
@@ -134,5 +259,53 @@ int main( void )
             return i_ret;
     }
 
+    /* A startcode ending the buffer, for all alignments of the end */
+    static const uint8_t tail[] = { 0, 1, 0, 0, 0, 1 };
+    p_data = malloc( 128 );
+    if( !p_data )
+        return 1;
+    printf("* Running tests on tail set:\n");
+    for( size_t i_end = 64; i_end <= 128 && i_ret == 0; i_end++ )
+    {
+        memset( p_data, 0x42, 128 );
+        memcpy( &p_data[i_end - sizeof(tail)], tail, sizeof(tail) );
+        for( size_t i_start = i_end - 32; i_start < i_end && i_ret == 0; i_start++ )
+        {
+            i_ret = run_random_set( &p_data[i_start], &p_data[i_end] );
+            if( i_ret != 0 )
+                printf("failed on [%zu,%zu]\n", i_start, i_end);
+        }
+    }
+    free( p_data );
+    if( i_ret != 0 )
+        return i_ret;
+
+    /* Startcodes are dense here, with many near misses, and sparser with
+     * each seed, in buffers of varying sizes */
+    for( unsigned i_seed = 0; i_seed < 16; i_seed++ )
+    {
+        const size_t i_random = 256 + 61 * i_seed;
+        p_data = malloc( i_random );
+        if( !p_data )
+            return 1;
+
+        srand( i_seed );
+        for( size_t i = 0; i < i_random; i++ )
+        {
+            int r = rand() % (8 + i_seed);
+            p_data[i] = r < 5 ? 0 : r < 7 ? 1 : 0x42;
+        }
+        printf("* Running tests on random set %u:\n", i_seed);
+        i_ret = run_random_sets( p_data, i_random );
+        if( i_ret == 0 )
+        {
+            printf("* Running tests on bytestream %u:\n", i_seed);
+            i_ret = run_bytestream_set( p_data, i_random );
+        }
+        free( p_data );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+
     return 0;
 }
@@ -0,0 +1,157 @@
+/*****************************************************************************
+ * startcode_bench.c: startcode scanners benchmark
+ *****************************************************************************
+ * Copyright © 2026 VideoLabs and VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Scans a synthetic Annex B bitstream with each available startcode
+ * scanner, and through the block bytestream, and reports throughput.
+ *
+ * usage: test_modules_packetizer_startcode_bench [size MiB] [NAL size]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_block_helper.h>
+#include <vlc_tick.h>
+
+#include "../modules/packetizer/startcode_helper.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef const uint8_t *(*startcode_find_t)(const uint8_t *, const uint8_t *);
+
+/* Random payload, escaped like a real NAL (no 00 00 0x below 4),
+ * with zeros frequent enough to hit the slow paths */
+static void generate( uint8_t *p, size_t i_size, size_t i_nal, unsigned *pi_count )
+{
+    unsigned i_count = 0;
+    size_t i_zeros = 0;
+    srand( 42 );
+    for( size_t i = 0; i < i_size; i++ )
+    {
+        if( i % i_nal == 0 && i + 4 <= i_size )
+        {
+            p[i++] = 0; p[i++] = 0; p[i++] = 1; p[i] = 0x65;
+            i_zeros = 0;
+            i_count++;
+            continue;
+        }
+        uint8_t v = (rand() % 16) ? rand() : 0;
+        if( i_zeros >= 2 && v <= 3 )
+            v = 3; /* emulation prevention */
+        i_zeros = v ? 0 : i_zeros + 1;
+        p[i] = v;
+    }
+    *pi_count = i_count;
+}
+
+static void bench( const char *psz_name, startcode_find_t pf_find,
+                   const uint8_t *p_data, size_t i_size, unsigned i_count )
+{
+    unsigned i_found = 0;
+    const uint8_t *p_end = &p_data[i_size];
+    vlc_tick_t i_start = vlc_tick_now();
+    for( const uint8_t *p = pf_find( p_data, p_end ); p; p = pf_find( p + 3, p_end ) )
+        i_found++;
+    vlc_tick_t i_elapsed = vlc_tick_now() - i_start;
+
+    printf( "%-12s %8.1f MiB/s%s\n", psz_name,
+            (double) i_size / 1048576 / secf_from_vlc_tick( __MAX(i_elapsed, 1) ),
+            i_found == i_count ? "" : " (wrong count)" );
+}
+
+static void bench_bytestream( const char *psz_name, block_startcode_helper_t pf_find,
+                              const uint8_t *p_data, size_t i_size, size_t i_block,
+                              unsigned i_count )
+{
+    static const uint8_t startcode[3] = { 0, 0, 1 };
+    block_bytestream_t bytestream;
+    block_BytestreamInit( &bytestream );
+
+    for( size_t i = 0; i < i_size; i += i_block )
+    {
+        size_t i_copy = __MIN( i_block, i_size - i );
+        block_t *p_block = block_Alloc( i_copy );
+        if( !p_block )
+            break;
+        memcpy( p_block->p_buffer, &p_data[i], i_copy );
+        block_BytestreamPush( &bytestream, p_block );
+    }
+
+    unsigned i_found = 0;
+    size_t i_offset = 0;
+    vlc_tick_t i_start = vlc_tick_now();
+    while( block_FindStartcodeFromOffset( &bytestream, &i_offset, startcode, 3,
+                                          pf_find, NULL ) == VLC_SUCCESS )
+    {
+        /* consume the NAL, as packetizers do */
+        i_found++;
+        block_SkipBytes( &bytestream, i_offset + 3 );
+        block_BytestreamFlush( &bytestream );
+        i_offset = 0;
+    }
+    vlc_tick_t i_elapsed = vlc_tick_now() - i_start;
+
+    printf( "%-12s %8.1f MiB/s%s\n", psz_name,
+            (double) i_size / 1048576 / secf_from_vlc_tick( __MAX(i_elapsed, 1) ),
+            i_found == i_count ? "" : " (wrong count)" );
+
+    block_BytestreamRelease( &bytestream );
+}
+
+int main( int argc, char **argv )
+{
+    size_t i_size = (argc > 1 ? strtoul( argv[1], NULL, 10 ) : 64) << 20;
+    size_t i_nal = argc > 2 ? strtoul( argv[2], NULL, 10 ) : 65536;
+    if( i_size == 0 || i_nal < 4 )
+        return 1;
+
+    uint8_t *p_data = malloc( i_size );
+    if( !p_data )
+        return 1;
+
+    unsigned i_count;
+    generate( p_data, i_size, i_nal, &i_count );
+    printf( "%zu MiB, %u startcodes\n", i_size >> 20, i_count );
+
+    bench( "bits", startcode_FindAnnexB_Bits, p_data, i_size, i_count );
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
+        bench( "sse2", startcode_FindAnnexB_SSE2, p_data, i_size, i_count );
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+        bench( "avx2", startcode_FindAnnexB_AVX2, p_data, i_size, i_count );
+#endif
+#ifdef CAN_COMPILE_STARTCODE_NEON
+    bench( "neon", startcode_FindAnnexB_NEON, p_data, i_size, i_count );
+#endif
+
+    /* through block chains, as packetizers do (1316 = 7 TS packets) */
+    bench_bytestream( "bs memchr", NULL, p_data, i_size, 1316, i_count );
+    bench_bytestream( "bs helper", startcode_FindAnnexB, p_data, i_size, 1316, i_count );
+
+    free( p_data );
+    return 0;
+}
@@ -159,6 +159,40 @@ int main(void)
     assert(vlc_stream_Eof(reader));
     vlc_stream_Delete(reader);
 
+    writer = vlc_stream_fifo_New(parent, &reader);
+    assert(writer != NULL);
+    val = vlc_stream_fifo_Write(writer, "1st block\n", 10);
+    assert(val == 10);
+
+    /* partial peeks do not wait for more than what was queued */
+    val = vlc_stream_PeekPartial(reader, &peek, 40);
+    assert(val == 10);
+    assert(vlc_stream_Tell(reader) == 0);
+    assert(memcmp(peek, "1st block\n", 10) == 0);
+
+    val = vlc_stream_PeekPartial(reader, &peek, 5);
+    assert(val == 5);
+    assert(memcmp(peek, "1st b", 5) == 0);
+
+    val = vlc_stream_fifo_Write(writer, "2nd block\n", 10);
+    assert(val == 10);
+    val = vlc_stream_Peek(reader, &peek, 20);
+    assert(val == 20);
+    assert(memcmp(peek, "1st block\n2nd block\n", 20) == 0);
+
+    vlc_stream_fifo_Close(writer);
+    val = vlc_stream_PeekPartial(reader, &peek, 40);
+    assert(val == 20);
+    assert(vlc_stream_Tell(reader) == 0);
+
+    val = vlc_stream_Read(reader, buf, 16);
+    assert(val == 16);
+    val = vlc_stream_Read(reader, buf, 4);
+    assert(val == 4);
+    val = vlc_stream_PeekPartial(reader, &peek, 40);
+    assert(val == 0);
+    vlc_stream_Delete(reader);
+
     writer = vlc_stream_fifo_New(parent, &reader);
     assert(writer != NULL);
     val = vlc_stream_fifo_Write(writer, "1st block\n", 10);